@@ -63,6 +63,9 @@ bool game::update()
 
     // States
     m_state_update();
+
+    // Send everything the frame queued
+    NetMgr.Flush();
     m_state_render();
 
     m_window->swap_buffers();
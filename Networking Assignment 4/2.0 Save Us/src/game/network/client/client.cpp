@@ -36,15 +36,11 @@ namespace network {
             return false;
         }
 
-        //integer for the recv
-        int err = 1;
         //iterate until we read and process all the datagrams in the net
-        while (err > 0)
+        while (alive)
         {
             //recv a new packet
-            std::vector<char> recv_buffer;
-            recv_buffer.resize(MAX_PAYLOAD_SIZE + sizeof(net_header));
-            int remote_size = sizeof(m_remote_endpoint);
+            socklen_t remote_size = sizeof(m_remote_endpoint);
             int err = recvfrom(m_socket, recv_buffer.data(), static_cast<int>(recv_buffer.size()), 0, reinterpret_cast<sockaddr*>(&m_remote_endpoint), &remote_size);
 
             //check for errors in recv
@@ -63,8 +59,9 @@ namespace network {
                 break;
             }
             //we recieved a packet so we need to process it
-            else
-                alive = ProcessPacket(recv_buffer, err);
+            net_packet packet;
+            if (UnpackPacket(recv_buffer.data(), err, packet))
+                alive = ProcessPacket(packet);
         }
         return alive;
     }
@@ -118,7 +115,9 @@ namespace network {
         network_destroy();
 
         //clean the map and queue 
-        sended_packets.clear();
+        sended_packets.Clear();
+        std::cout << "Stale updates discarded: " << sequenced.Discarded() << std::endl;
+        std::cout << "Reliable packets lost: " << lost_packets << std::endl;
     }
 
     /**
@@ -140,8 +139,6 @@ namespace network {
                 return false;
 
             //check for server to acknowledge the connection
-            std::vector<char> recv_buffer;
-            recv_buffer.resize(MAX_PAYLOAD_SIZE + sizeof(net_header));
             int err = recvfrom(m_socket, recv_buffer.data(), static_cast<int>(recv_buffer.size()), 0, nullptr, nullptr);
 
             //check if error happened
@@ -168,21 +165,24 @@ namespace network {
             else
             {
                 //process the packet recieved
-                net_header recv_header = {};
-                char message[MAX_PAYLOAD_SIZE] = { 0 };
-                UnpackPacket(recv_buffer, err, recv_header, message);
-                sended_packets.erase(recv_header.sequence);
-
-                //if it is acknowledge and syn we send the acknowledge and end the 3way handsake
-                if (recv_header.flag == static_cast<int>(net_flag::NET_SYN_ACK) && recv_header.type == static_cast<int>(net_action::NET_CONECTION) && recv_header.sequence == 0)
+                net_packet packet;
+                if (!UnpackPacket(recv_buffer.data(), err, packet))
+                    continue;
+                net_header const& recv_header = packet.header;
+                ProcessAcks(recv_header);
+
+                //if it is acknowledge and syn we send the acknowledge and end the 3way handsake,
+                //a resent syn ack comes with a new sequence
+                if (recv_header.flag == static_cast<int>(net_flag::NET_SYN_ACK) && recv_header.type == static_cast<int>(net_action::NET_CONECTION))
                 {
+                    PacketReceived(recv_header);
                     std::cout << "Received SYN-ACK: " << std::endl;
                     m_id = recv_header.id;
                     //sent the ack back
                     SendMsg(net_flag::NET_ACK, net_action::NET_CONECTION, m_id, 0, false);
 
                     //process the information of the rest of ships
-                    NetMgr.AllShipsPacketProcess(recv_header, message, true);
+                    NetMgr.AllShipsPacketProcess(recv_header, packet.msg, true);
                     
                     std::cout << "Sending ACK: " << std::endl;
                     std::cout << "Client Connected: " << std::endl;
@@ -196,19 +196,18 @@ namespace network {
 
     /**
     * this function will process a packet recieved and make different operations depending on the type of packet
-    * @param packet         - all the information of the packet plus the data
-    * @param data_length    - length of the packet
-    * @return  void
+    * @param packet         - header of the packet and a view of its data in the receive buffer
+    * @return  bool
     */
-    bool client::ProcessPacket(std::vector<char> packet, int data_length)
+    bool client::ProcessPacket(net_packet const& packet)
     {
-        //initialize variables to unpack the message
-        net_header recv_header{};
-        char msg[MAX_PAYLOAD_SIZE] = { 0 };
+        net_header const& recv_header = packet.header;
         current_alive_time = 0.0f;
 
-        //get the info of the header and the message separated from the packet
-        UnpackPacket(packet, data_length, recv_header, msg);
+        //every packet acknowledges what the server received from us, and what we received
+        //from it is acknowledged in the next packet we send
+        ProcessAcks(recv_header);
+        PacketReceived(recv_header);
 
         //cast the info
         net_flag flag     = static_cast<net_flag>(recv_header.flag);
@@ -228,22 +227,27 @@ namespace network {
             SendMsg(net_flag::NET_ACK, net_action::NET_CONECTION,m_id, 0, false);
         }
 
-        //we recieved an acknowledge of a sended packet so we erase it from the map
+        //the acks it carried were already processed
         else if (flag == net_flag::NET_ACK)
         {
-            if (mbdebug)   std::cout << "Recieving ACK ID : " << recv_header.sequence << std::endl;
-            sended_packets.erase(recv_header.sequence);
+            if (mbdebug)   std::cout << "Recieving ACK ID : " << recv_header.ack << std::endl;
         }
            
         //we recieved a proper packet of data so we need to check if its valid
         else if (flag == net_flag::NET_SEQ)
         {
-            //if the message expect and acknowledge we send back an acknowledge of it
-            if(recv_header.expect_ack)
-                SendMsg(net_flag::NET_ACK, action, m_id, recv_header.sequence, false);
+            //process the packet, or every message in it if it is a bundle, an update older than
+            //one already applied is dropped
+            auto process = [this](net_header const& header, char* data, int length)
+            {
+                if (!sequenced.IsStale(header))
+                    NetMgr.ProcessPacket(header, data, length);
+            };
 
-            //and process the packet
-            NetMgr.ProcessPacket(recv_header, msg, data_length);
+            if (action == net_action::NET_BUNDLE)
+                UnpackBundle(recv_header, packet.msg, packet.msg_length, process);
+            else
+                process(recv_header, packet.msg, packet.msg_length);
         }
         return true;
     }
@@ -16,7 +16,7 @@ namespace network
     class client : public BaseNetwork
     {
       private:
-        bool ProcessPacket(std::vector<char> packet, int data_length);
+        bool ProcessPacket(net_packet const& packet);
         bool ConnectToServer();
 
       public:
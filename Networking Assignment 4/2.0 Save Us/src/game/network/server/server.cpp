@@ -30,11 +30,19 @@ namespace network {
 		network_destroy();
 
 		//clean the map and queue 
-		sended_packets.clear();
+		sended_packets.Clear();
 
 		//delete all the clients
+		unsigned stale_discarded = removed_stale_discarded;
+		unsigned lost = removed_lost_packets + lost_packets;
 		for(auto& it : mClients)
+		{
+			stale_discarded += it.second->sequenced.Discarded();
+			lost += it.second->lost_packets;
 			delete it.second;
+		}
+		std::cout << "Stale updates discarded: " << stale_discarded << std::endl;
+		std::cout << "Reliable packets lost: " << lost << std::endl;
 	}
 
 	/**
@@ -80,17 +88,13 @@ namespace network {
 	*/
 	bool server::Update()
 	{
-		//integer for the recv
-		int err = 1;
 		//iterate until we read and process all the datagrams in the net
-		while (err > 0)
+		while (true)
 		{
 			//check for a new packet
 			sockaddr_in	remote_endpoint = {};
-			int remote_endpoint_size = sizeof(remote_endpoint);
-			std::vector<char> recv_buffer;
-			recv_buffer.resize(MAX_PAYLOAD_SIZE + sizeof(net_header));
-			err = recvfrom(m_socket, recv_buffer.data(), static_cast<int>(recv_buffer.size()), 0, reinterpret_cast<sockaddr*>(&remote_endpoint), &remote_endpoint_size);
+			socklen_t remote_endpoint_size = sizeof(remote_endpoint);
+			int err = recvfrom(m_socket, recv_buffer.data(), static_cast<int>(recv_buffer.size()), 0, reinterpret_cast<sockaddr*>(&remote_endpoint), &remote_endpoint_size);
 
 			//check for errors in recv
 			if (err == -1)
@@ -106,25 +110,20 @@ namespace network {
 			//we recieved a packet so we need to process it
 			else
 			{
-				//initialize variables to unpack the message
-				net_header recv_header{};
-				char msg[MAX_PAYLOAD_SIZE] = { 0 };
-
-				//get the info of the header and the message separated from the packet
-				UnpackPacket(recv_buffer, err, recv_header, msg);
+				//get the info of the header and a view of the message, skipping runt datagrams
+				net_packet packet;
+				if (!UnpackPacket(recv_buffer.data(), err, packet))
+					continue;
 
 				//cast the info
-				net_flag flag = static_cast<net_flag>(recv_header.flag);
-				net_action action = static_cast<net_action>(recv_header.type);
+				net_action action = static_cast<net_action>(packet.header.type);
 
 				if (action == net_action::NET_CONECTION)
-					ConnectClient(recv_header, msg, remote_endpoint);
-				else
-				{
-					auto it = mClients.find(recv_header.id);
-					if (it == mClients.end()) return true;
-					ProcessPacket(recv_header, msg, err - sizeof(net_header));
-				}
+					ConnectClient(packet.header, packet.msg, remote_endpoint);
+
+				//packets from unknown clients are dropped, the rest of the queue still gets drained
+				else if (mClients.find(packet.header.id) != mClients.end())
+					ProcessPacket(packet.header, packet.msg, packet.msg_length);
 			}
 		}
 
@@ -166,6 +165,9 @@ namespace network {
 				mClients[new_client->m_id] = new_client;
 			}
 
+			//the syn ack carries the ack of this syn
+			new_client->PacketReceived(recv_header);
+
 			//send the syn ack to the client with all the information of the clients and the new pos of the new client
 			std::vector<char> msg = NetMgr.AllShipsPacketCreate(true, vec2(clients_count * 30, 0));
 			new_client->SendMsg(net_flag::NET_SYN_ACK, net_action::NET_CONECTION, new_client->m_id, 0, true, msg.data(), msg.size());
@@ -173,7 +175,7 @@ namespace network {
 		else if (flag == net_flag::NET_ACK)
 		{
 			std::cout << "Client Connected ID: " << recv_header.id << std::endl;
-			mClients[recv_header.id]->sended_packets.erase(recv_header.sequence);
+			mClients[recv_header.id]->ProcessAcks(recv_header);
 
 			net_player new_player;
 			new_player.id = recv_header.id;
@@ -195,33 +197,80 @@ namespace network {
 		//cast the info
 		net_flag flag = static_cast<net_flag>(recv_header.flag);
 		net_action action = static_cast<net_action>(recv_header.type);
-		mClients[recv_header.id]->current_alive_time = 0.0f;
+		servers_client* sender = mClients[recv_header.id];
+		sender->current_alive_time = 0.0f;
+
+		//every packet acknowledges what the client received from us, and what we received from it
+		//is acknowledged in the next packet we send it
+		sender->ProcessAcks(recv_header);
+		sender->PacketReceived(recv_header);
 
-		//we recieved an acknowledge of a sended packet so we erase it from the map
 		if (flag == net_flag::NET_ACK)
 		{
-			if (mbdebug)   std::cout << "Recieving ACK ID : " << recv_header.sequence << std::endl;
-			mClients[recv_header.id]->sended_packets.erase(recv_header.sequence);
+			if (mbdebug)   std::cout << "Recieving ACK ID : " << recv_header.ack << std::endl;
 		}
 
 		//we recieved a proper packet of data 
 		else if (flag == net_flag::NET_SEQ)
 		{
-			//if the message expect and acknowledge we send back an acknowledge of it
-			if (recv_header.expect_ack)
-				mClients[recv_header.id]->SendMsg(net_flag::NET_ACK, action, m_id, recv_header.sequence, false);
-
-			//and then process the packet
-			SendMsg(flag, action, recv_header.id, m_seq, false, msg, data_length);
-			NetMgr.ProcessPacket(recv_header, msg, data_length);
+			//relay every message to the rest of the clients and then process it, an update older than
+			//one already seen from this client is dropped before either
+			auto process = [this, sender](net_header const& header, char* data, int length)
+			{
+				if (sender->sequenced.IsStale(header))
+					return;
+				QueueMsg(static_cast<net_action>(header.type), header.id, false, data, length);
+				NetMgr.ProcessPacket(header, data, length);
+			};
+
+			if (action == net_action::NET_BUNDLE)
+				UnpackBundle(recv_header, msg, data_length, process);
+			else
+				process(recv_header, msg, data_length);
 		}
 	}
 
 	void server::SendMsg(net_flag flag, net_action action, int id, int seq_num, bool expected_acknowledge, const char* msg, int size)
 	{
+		//the payload is the same for every client so it is copied once and shared, each client only builds its header
+		shared_payload payload;
+		if (size > 0)
+			payload = std::make_shared<const std::vector<char>>(msg, msg + size);
+
 		for (auto& it : mClients)
 			if(id == 0 || id != it.first)
-				it.second->SendMsg(flag, action, id, ++it.second->m_seq, expected_acknowledge, msg, size);
+				it.second->SendShared(flag, action, id, ++it.second->m_seq, expected_acknowledge, payload);
+	}
+
+	void server::QueueMsg(net_action action, int id, bool expected_acknowledge, const char* msg, int size)
+	{
+		//a message for everyone goes in the server's own queues, flushed through SendMsg above
+		if (id == 0)
+		{
+			BaseNetwork::QueueMsg(action, id, expected_acknowledge, msg, size);
+			return;
+		}
+
+		//a message from a client goes in that client's own queues, the bundles are sent as the client
+		//so SendMsg above shares each of them with everyone but it
+		if (sizeof(net_msg_header) + size > MAX_PAYLOAD_SIZE)
+		{
+			SendMsg(net_flag::NET_SEQ, action, id, ++m_seq, expected_acknowledge, msg, size);
+			return;
+		}
+
+		net_relay_queues& relay = relayed_msgs[id];
+		QueueInto(expected_acknowledge ? relay.reliable : relay.unreliable, expected_acknowledge, id, action, id, msg, size);
+	}
+
+	void server::FlushMsgs()
+	{
+		BaseNetwork::FlushMsgs();
+		for (auto& it : relayed_msgs)
+		{
+			FlushQueue(it.second.reliable, true, it.first);
+			FlushQueue(it.second.unreliable, false, it.first);
+		}
 	}
 
 	servers_client* server::CheckDuplicateClient(sockaddr_in const& _remote_address)
@@ -248,6 +297,11 @@ namespace network {
 		NetMgr.RemovePlayer(client_id);
 		servers_client* temp_cl = cl_it->second;
 		mClients.erase(cl_it);
+		removed_stale_discarded += temp_cl->sequenced.Discarded();
+		removed_lost_packets += temp_cl->lost_packets;
+
+		//what it sent this frame is not relayed after it is gone
+		relayed_msgs.erase(client_id);
 
 		//delete the client
 		delete temp_cl;
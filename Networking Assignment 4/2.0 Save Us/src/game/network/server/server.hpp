@@ -19,11 +19,27 @@ namespace network {
     {
     public:
         void SendMsg(net_flag flag, net_action action, int id, int seq_num = 0, bool expected_acknowledge = true, const char* msg = nullptr, int size = 0);
+        //messages to every client (id 0) are coalesced once for all of them, messages relayed from a client
+        //once for the rest of them
+        void QueueMsg(net_action action, int id, bool expected_acknowledge = false, const char* msg = nullptr, int size = 0);
+        void FlushMsgs();
 
       private:
         //vector of clients
         int clients_count = 0;
 
+        //messages relayed from each client, every bundle is built once and shared by the other clients
+        struct net_relay_queues
+        {
+            std::vector<char>   reliable;
+            std::vector<char>   unreliable;
+        };
+        std::unordered_map<int, net_relay_queues> relayed_msgs;
+
+        //stale state updates dropped from clients that already left
+        unsigned removed_stale_discarded = 0;
+        unsigned removed_lost_packets = 0;
+
         servers_client* CheckDuplicateClient(sockaddr_in const& _remote_address);
         void ConnectClient(net_header recv_header, char* msg, sockaddr_in const& _remote_address);
         void ProcessPacket(net_header recv_header, char* msg, int data_length);
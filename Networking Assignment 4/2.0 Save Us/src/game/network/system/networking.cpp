@@ -8,6 +8,8 @@
 */
 
 #include "networking.hpp"
+#include <algorithm>
+#include <cmath>
 #include "game/network/client/client.hpp"
 #include "game/network/server/server.hpp"
 #include "game/TimeMgr/Time.h"
@@ -246,6 +248,15 @@ namespace network {
         }
     }
 
+    /**
+    * this function will send every message queued this frame
+    * @return  void
+    */
+    void NetworkManager::Flush()
+    {
+        system->FlushMsgs();
+    }
+
     /**
     * this function will create a packet depedning on the input
     * @param action
@@ -264,17 +275,17 @@ namespace network {
             net_player player = GetPlayerInfo();
             std::vector<char> msg(sizeof(net_player));
             memcpy(msg.data(), &player, sizeof(net_player));
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_UPDATE, system->m_id, ++system->m_seq, expected_answer, msg.data(), sizeof(net_player));
+            system->QueueMsg(net_action::NET_PLAYER_UPDATE, system->m_id, expected_answer, msg.data(), sizeof(net_player));
             break;
         }
         case network::net_action::NET_PLAYER_PRTCL_MOVE:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_PRTCL_MOVE, system->m_id, ++system->m_seq, expected_answer, data, data_length);
+            system->QueueMsg(net_action::NET_PLAYER_PRTCL_MOVE, system->m_id, expected_answer, data, data_length);
             break;
         }
         case network::net_action::NET_PLAYER_DEATH:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_DEATH, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_PLAYER_DEATH, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_SCORE_UPDATE:
@@ -291,53 +302,53 @@ namespace network {
                 std::memcpy(msg.data() + sizeof(int) + 2 * i * sizeof(int) + 4, &(it.second), sizeof(int));
                 i++;
             }
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_SCORE_UPDATE, system->m_id, ++system->m_seq, expected_answer, msg.data(), (int)msg.size());
+            system->QueueMsg(net_action::NET_SCORE_UPDATE, system->m_id, expected_answer, msg.data(), (int)msg.size());
             break;
         }
         case network::net_action::NET_PLAYER_SHOT:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_SHOT, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_PLAYER_SHOT, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_PLAYER_BOMB:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_BOMB, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_PLAYER_BOMB, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_PLAYER_MISSILE:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_MISSILE, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_PLAYER_MISSILE, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_ASTEROID_NEW:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_ASTEROID_NEW, system->m_id, ++system->m_seq, expected_answer, data, data_length);
+            system->QueueMsg(net_action::NET_ASTEROID_NEW, system->m_id, expected_answer, data, data_length);
             break;
         }
         case network::net_action::NET_ASTEROID_UPDATE:
         {
             std::vector<char> ast_msg = AllAsteroidsPacketCreate();
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_ASTEROID_UPDATE, system->m_id, ++system->m_seq, expected_answer, ast_msg.data(), (int)ast_msg.size());
+            system->QueueMsg(net_action::NET_ASTEROID_UPDATE, system->m_id, expected_answer, ast_msg.data(), (int)ast_msg.size());
             break;
         }
         case network::net_action::NET_ASTEROID_DESTROY:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_ASTEROID_DESTROY, system->m_id, ++system->m_seq, expected_answer, data, data_length);
+            system->QueueMsg(net_action::NET_ASTEROID_DESTROY, system->m_id, expected_answer, data, data_length);
             break;
         }
         case network::net_action::NET_PLAYER_DISCONECTS:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_PLAYER_DISCONECTS, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_PLAYER_DISCONECTS, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_GAME_OVER:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_GAME_OVER, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_GAME_OVER, system->m_id, expected_answer);
             break;
         }
         case network::net_action::NET_GAME_WON:
         {
-            system->SendMsg(net_flag::NET_SEQ, net_action::NET_GAME_WON, system->m_id, ++system->m_seq, expected_answer);
+            system->QueueMsg(net_action::NET_GAME_WON, system->m_id, expected_answer, data, data_length);
             break;
         }
         default:
@@ -505,26 +516,218 @@ namespace network {
     */
     void BaseNetwork::SendMsg(net_flag flag, net_action action, int id, int seq_num, bool expected_acknowledge, const char* msg, int size)
     {
-        //datagram that will store all the information
-        std::vector<char> send_buffer(sizeof(net_header) + size);
+        //datagram that will store all the information, if an acknowledge is expected it is
+        //built straight into its slot of the ring so it can be resent
+        std::vector<char> send_buffer;
+        std::vector<char>* datagram = &send_buffer;
+        if (expected_acknowledge)
+        {
+            net_sended_packet& sended = InsertSended(static_cast<uint32_t>(seq_num));
+            sended.timer = 0.0f;
+            sended.payload.reset();
+            datagram = &sended.data;
+        }
+        datagram->resize(sizeof(net_header) + size);
+
+        //remember when it left to time the ack, acks sent on their own reuse the last sequence
+        if (flag != net_flag::NET_ACK)
+            sended_times.Insert(static_cast<uint32_t>(seq_num)) = std::chrono::steady_clock::now();
 
-        //initialize the header
+        //initialize the header, it carries every ack we owe so none has to be sent on its own
         net_header header = CreateHeader(flag, action, expected_acknowledge, id, seq_num);
+        ack_pending = false;
+        current_ack_time = 0.0f;
 
         //set the header and the message in a single datagram
-        memcpy(send_buffer.data(), &header, sizeof(header));
-        memcpy(send_buffer.data() + sizeof(header), msg, size);
+        memcpy(datagram->data(), &header, sizeof(header));
+        if (size > 0)
+            memcpy(datagram->data() + sizeof(header), msg, size);
+
+        //send the message
+        sendto(m_socket, datagram->data(), static_cast<int>(datagram->size()), 0, reinterpret_cast<sockaddr*>(&m_remote_endpoint), sizeof(m_remote_endpoint));
+    }
+
+    /**
+    * this function will send a payload shared with other connections behind a header of its own, the payload is
+    * not copied and if an acknowledge is expected the ring keeps a reference to it instead of a copy
+    * @param flag                   - flag of the operation
+    * @param action                 - action that correspond to this packet
+    * @param id                     - id of the player the packet is about
+    * @param seq_num                - sequence number corresponding to this packet
+    * @param expected_acknowledge   - bool to check if it needs to get acknowledge
+    * @param payload                - data that will have the packet, can be null
+    * @return  void
+    */
+    void BaseNetwork::SendShared(net_flag flag, net_action action, int id, int seq_num, bool expected_acknowledge, shared_payload const& payload)
+    {
+        //remember when it left to time the ack
+        if (flag != net_flag::NET_ACK)
+            sended_times.Insert(static_cast<uint32_t>(seq_num)) = std::chrono::steady_clock::now();
+
+        net_header header = CreateHeader(flag, action, expected_acknowledge, id, seq_num);
+        ack_pending = false;
+        current_ack_time = 0.0f;
 
-        //store it in the map if an acknowledge from the server is expected
         if (expected_acknowledge)
         {
-            //add the new packet into the map of packets
-            std::pair<float, std::vector<char>> info{ 0.0f, send_buffer };
-            sended_packets[seq_num] = info;
+            net_sended_packet& sended = InsertSended(static_cast<uint32_t>(seq_num));
+            sended.timer = 0.0f;
+            sended.data.resize(sizeof(net_header));
+            memcpy(sended.data.data(), &header, sizeof(net_header));
+            sended.payload = payload;
         }
 
-        //send the message
-        sendto(m_socket, send_buffer.data(), static_cast<int>(send_buffer.size()), 0, reinterpret_cast<sockaddr*>(&m_remote_endpoint), sizeof(m_remote_endpoint));
+        //send the header and the payload as one datagram
+        const char* body = payload ? payload->data() : nullptr;
+        int body_size = payload ? static_cast<int>(payload->size()) : 0;
+        sendto_parts(m_socket, reinterpret_cast<const char*>(&header), sizeof(net_header), body, body_size, m_remote_endpoint);
+    }
+
+    /**
+    * this function will queue a message to go out with the rest of the frame in as few NET_BUNDLE packets as possible,
+    * each message keeps its own action and id in a sub-header
+    * @param action                 - action that correspond to this message
+    * @param id                     - id of the player the message is about
+    * @param expected_acknowledge   - bool to check if it needs to get acknowledge
+    * @param msg                    - data of the message
+    * @param size                   - size of the data
+    * @return  void
+    */
+    void BaseNetwork::QueueMsg(net_action action, int id, bool expected_acknowledge, const char* msg, int size)
+    {
+        //a message too big to share a packet goes out on its own
+        if (sizeof(net_msg_header) + size > MAX_PAYLOAD_SIZE)
+        {
+            SendMsg(net_flag::NET_SEQ, action, id, ++m_seq, expected_acknowledge, msg, size);
+            return;
+        }
+
+        //reliable and unreliable messages go in different packets so only what needs it gets resent
+        QueueInto(expected_acknowledge ? reliable_msgs : unreliable_msgs, expected_acknowledge, m_id, action, id, msg, size);
+    }
+
+    /**
+    * this function will add a message with its sub-header to a queue, a full queue is sent first
+    * @param queue                  - messages with their sub-headers
+    * @param expected_acknowledge   - bool to check if the queue needs to get acknowledge
+    * @param sender                 - id the NET_BUNDLE packets of this queue are sent as
+    * @param action                 - action that correspond to this message
+    * @param id                     - id of the player the message is about
+    * @param msg                    - data of the message
+    * @param size                   - size of the data
+    * @return  void
+    */
+    void BaseNetwork::QueueInto(std::vector<char>& queue, bool expected_acknowledge, int sender, net_action action, int id, const char* msg, int size)
+    {
+        if (queue.size() + sizeof(net_msg_header) + size > MAX_PAYLOAD_SIZE)
+            FlushQueue(queue, expected_acknowledge, sender);
+
+        net_msg_header msg_header = {};
+        msg_header.type = static_cast<char>(action);
+        msg_header.length = static_cast<unsigned short>(size);
+        msg_header.id = id;
+
+        size_t offset = queue.size();
+        queue.resize(offset + sizeof(net_msg_header) + size);
+        memcpy(queue.data() + offset, &msg_header, sizeof(net_msg_header));
+        if (size > 0)
+            memcpy(queue.data() + offset + sizeof(net_msg_header), msg, size);
+    }
+
+    /**
+    * this function will send the messages queued for this connection
+    * @return  void
+    */
+    void BaseNetwork::FlushMsgs()
+    {
+        FlushQueue(reliable_msgs, true, m_id);
+        FlushQueue(unreliable_msgs, false, m_id);
+    }
+
+    /**
+    * this function will send one queue of messages as a single NET_BUNDLE packet, the queue keeps its capacity
+    * @param queue                  - messages with their sub-headers
+    * @param expected_acknowledge   - bool to check if it needs to get acknowledge
+    * @param sender                 - id the packet is sent as
+    * @return  void
+    */
+    void BaseNetwork::FlushQueue(std::vector<char>& queue, bool expected_acknowledge, int sender)
+    {
+        if (queue.empty())
+            return;
+
+        SendMsg(net_flag::NET_SEQ, net_action::NET_BUNDLE, sender, ++m_seq, expected_acknowledge, queue.data(), static_cast<int>(queue.size()));
+        queue.clear();
+    }
+
+    /**
+    * this function will take the slot of the ring for a new packet that expects acknowledge, a packet still
+    * waiting there from a whole ring ago is resent and moved to a free slot instead of being overwritten
+    * @param sequence               - sequence number of the new packet
+    * @return  net_sended_packet&   - slot for the new packet
+    */
+    net_sended_packet& BaseNetwork::InsertSended(uint32_t sequence)
+    {
+        unsigned index = sended_packets.IndexOf(sequence);
+        if (sended_packets.IsValid(index) && sended_packets.SequenceAt(index) != sequence)
+            Relocate(index, index);
+
+        return sended_packets.Insert(sequence);
+    }
+
+    /**
+    * this function will resend the packet in a slot of the ring under the next sequence whose slot is free and
+    * move it there, the sequences skipped over are never sent
+    * @param index                  - slot of the packet to resend
+    * @param reserved               - slot a new packet is about to take, nothing is moved into it
+    * @return  void
+    */
+    void BaseNetwork::Relocate(unsigned index, unsigned reserved)
+    {
+        uint32_t sequence = static_cast<uint32_t>(++m_seq);
+        unsigned target = sended_packets.IndexOf(sequence);
+        for (unsigned tries = 1; target == reserved || (target != index && sended_packets.IsValid(target)); tries++)
+        {
+            //every slot is waiting for an ack, the packet has nowhere left to go
+            if (tries >= sended_packets.Size())
+            {
+                sended_packets.EntryAt(index).payload.reset();
+                sended_packets.Remove(sended_packets.SequenceAt(index));
+                lost_packets++;
+                return;
+            }
+
+            sequence = static_cast<uint32_t>(++m_seq);
+            target = sended_packets.IndexOf(sequence);
+        }
+
+        //moving the bytes between slots keeps both buffers allocated
+        net_sended_packet& sended = sended_packets.EntryAt(index);
+        sended_packets.Remove(sended_packets.SequenceAt(index));
+        net_sended_packet& resent = sended_packets.Insert(sequence);
+        if (&resent != &sended)
+        {
+            std::swap(resent.data, sended.data);
+            std::swap(resent.payload, sended.payload);
+            sended.payload.reset();
+        }
+        resent.timer = 0.0f;
+
+        //refresh the sequence and the acks in the stored header
+        net_header header;
+        memcpy(&header, resent.data.data(), sizeof(header));
+        header.sequence = static_cast<int>(sequence);
+        header.ack = static_cast<int>(remote_sequence);
+        header.ack_bits = remote_ack_bits;
+        memcpy(resent.data.data(), &header, sizeof(header));
+        ack_pending = false;
+        current_ack_time = 0.0f;
+        sended_times.Insert(sequence) = std::chrono::steady_clock::now();
+
+        if (resent.payload)
+            sendto_parts(m_socket, resent.data.data(), static_cast<int>(resent.data.size()), resent.payload->data(), static_cast<int>(resent.payload->size()), m_remote_endpoint);
+        else
+            sendto(m_socket, resent.data.data(), static_cast<int>(resent.data.size()), 0, reinterpret_cast<sockaddr*>(&m_remote_endpoint), sizeof(m_remote_endpoint));
     }
 
     /**
@@ -543,24 +746,30 @@ namespace network {
         memcpy(&header.expect_ack, &expected_ack, 1);
         memcpy(&header.sequence, &sequence, 4);
         memcpy(&header.id, &id, 4);
+        header.ack = static_cast<int>(remote_sequence);
+        header.ack_bits = remote_ack_bits;
 
 		return header;
 	}
 
     /**
-    * this function will unpack the header of the packet and the data of the packet and store them in the 
-    * variables provided
+    * this function will unpack the header of the packet and point the message at the data that follows it,
+    * the data is not copied so it stays in the buffer it was received in
     * @param packet                 - full packet information
     * @param data_length            - size of the packet
-    * @param recv_header            - variable to store the information of the header
-    * @param msg                    - array to store the data from the packet
-    * @return  void
+    * @param recv_packet            - variable to store the header and the view of the data
+    * @return  bool                 - false if the packet is too short to have a header
     */
-	void BaseNetwork::UnpackPacket(std::vector<char> packet, int data_length, net_header& recv_header, char* msg)
+	bool BaseNetwork::UnpackPacket(char* packet, int data_length, net_packet& recv_packet)
 	{
+		if (data_length < static_cast<int>(sizeof(net_header)))
+			return false;
+
 		//get the info of the header and the message separated from the packet
-		memcpy(&recv_header, packet.data(), sizeof(recv_header));
-		memcpy(msg, packet.data() + sizeof(recv_header), data_length - sizeof(recv_header));
+		memcpy(&recv_packet.header, packet, sizeof(net_header));
+		recv_packet.msg = packet + sizeof(net_header);
+		recv_packet.msg_length = data_length - static_cast<int>(sizeof(net_header));
+		return true;
 	}
 
     /**
@@ -570,20 +779,192 @@ namespace network {
     void BaseNetwork::UpdateSendedPackets()
     {
         //update the current_alive_timer since we didnt get a packet yet
-        current_alive_time += TimeMgr.GetDt();
+        float dt = TimeMgr.GetDt();
+        current_alive_time += dt;
 
         //update the timer of each of the packets
-        for (auto& it : sended_packets)
+        float timeout = RetransmitTimeout();
+        unsigned resends = 0;
+        uint32_t newest_sequence = static_cast<uint32_t>(m_seq);
+
+        //the oldest packet waiting for acknowledge, only its expiry backs the timeout off
+        bool any_outstanding = false;
+        uint32_t oldest_sequence = 0;
+        for (unsigned i = 0; i < sended_packets.Size(); i++)
+        {
+            if (sended_packets.IsValid(i) && (!any_outstanding || SequenceGreaterThan(oldest_sequence, sended_packets.SequenceAt(i))))
+            {
+                oldest_sequence = sended_packets.SequenceAt(i);
+                any_outstanding = true;
+            }
+        }
+
+        for (unsigned i = 0; i < sended_packets.Size(); i++)
+        {
+            //packets resent in this loop land in later slots too, they are not visited again
+            if (!sended_packets.IsValid(i) || SequenceGreaterThan(sended_packets.SequenceAt(i), newest_sequence))
+                continue;
+
+            //update the timer and check if we reach to the time to resend the packet, within the budget of this update
+            net_sended_packet& sended = sended_packets.EntryAt(i);
+            sended.timer += dt;
+            if (sended.timer < timeout || resends >= max_resends_per_update)
+                continue;
+            resends++;
+
+            //a timeout means the estimate is too low or the link is congested, the rest of a burst lost
+            //together was sent before the backoff began and does not double it again
+            uint32_t sequence = sended_packets.SequenceAt(i);
+            if (sequence == oldest_sequence && (rto_backoff == 1.0f || !SequenceGreaterThan(backoff_sequence, sequence)))
+            {
+                rto_backoff = std::min(rto_backoff * 2.0f, 64.0f);
+                backoff_sequence = static_cast<uint32_t>(m_seq) + 1;
+            }
+
+            //resend the packet under a new sequence so an ack always names one datagram
+            Relocate(i, sended_packets.Size());
+        }
+
+        //acks normally ride on the next packet, if nothing was sent for a while send them on their own
+        if (ack_pending)
         {
-            //update the timer and check if we reach to the time to resend the packet
-            it.second.first += TimeMgr.GetDt();
-            if (it.second.first >= acknowledge_timer.count())
+            current_ack_time += dt;
+            if (current_ack_time >= ack_delay_timer.count())
+                SendMsg(net_flag::NET_ACK, net_action::NET_ACK_ONLY, m_id, m_seq, false);
+        }
+    }
+
+    /**
+    * this function will remove from the ring every sended packet the header of a received packet acknowledges
+    * @param recv_header            - header of the received packet
+    * @return  void
+    */
+    void BaseNetwork::ProcessAcks(net_header const& recv_header)
+    {
+        //drop the packet and let go of its payload if it was shared
+        auto acknowledge = [this](uint32_t sequence)
+        {
+            if (net_sended_packet* sended = sended_packets.Find(sequence))
             {
-                //resend the packet
-                sendto(m_socket, it.second.second.data(), static_cast<int>(it.second.second.size()), 0, reinterpret_cast<sockaddr*>(&m_remote_endpoint), sizeof(m_remote_endpoint));
-                it.second.first = 0.0f;
+                sended->payload.reset();
+                sended_packets.Remove(sequence);
             }
+        };
+
+        uint32_t ack = static_cast<uint32_t>(recv_header.ack);
+        acknowledge(ack);
+        for (uint32_t i = 0; i < 32; i++)
+            if (recv_header.ack_bits & (1u << i))
+                acknowledge(ack - 1 - i);
+
+        //only the newest ack is timed, an older one may have waited for a lost packet to carry it,
+        //and a resent packet has a new sequence so the sample always belongs to one send
+        if (auto* sent_time = sended_times.Find(ack))
+        {
+            std::chrono::nanoseconds sample = std::chrono::steady_clock::now() - *sent_time;
+            sended_times.Remove(ack);
+            UpdateRtt(static_cast<float>(sample.count()));
+
+            //the backoff ends once a packet sent under it gets through
+            if (!SequenceGreaterThan(backoff_sequence, ack))
+                rto_backoff = 1.0f;
+        }
+    }
+
+    /**
+    * this function will fold a round trip sample into the smoothed round trip and its variance and recompute
+    * the resend timeout from them as rtt + 4 * variance, clamped between min_rto_timer and max_rto_timer
+    * @param sample                 - round trip of one packet in nanoseconds
+    * @return  void
+    */
+    void BaseNetwork::UpdateRtt(float sample)
+    {
+        if (rto == 0.0f)
+        {
+            smoothed_rtt = sample;
+            rtt_variance = sample * 0.5f;
+        }
+        else
+        {
+            rtt_variance = 0.75f * rtt_variance + 0.25f * std::abs(smoothed_rtt - sample);
+            smoothed_rtt = 0.875f * smoothed_rtt + 0.125f * sample;
+        }
+
+        rto = std::clamp(smoothed_rtt + 4.0f * rtt_variance, static_cast<float>(min_rto_timer.count()), static_cast<float>(max_rto_timer.count()));
+    }
+
+    /**
+    * this function will return how long a packet waits for acknowledge before it is resent
+    * @return  float                - nanoseconds
+    */
+    float BaseNetwork::RetransmitTimeout() const
+    {
+        float base = rto == 0.0f ? static_cast<float>(acknowledge_timer.count()) : rto;
+        return std::min(base * rto_backoff, static_cast<float>(max_rto_timer.count()));
+    }
+
+    /**
+    * this function will add the sequence of a received packet to the acks sent back in every header
+    * @param recv_header            - header of the received packet
+    * @return  void
+    */
+    void BaseNetwork::PacketReceived(net_header const& recv_header)
+    {
+        //acks sent on their own reuse the last sequence so they are never acknowledged back
+        if (static_cast<net_flag>(recv_header.flag) == net_flag::NET_ACK)
+            return;
+
+        uint32_t sequence = static_cast<uint32_t>(recv_header.sequence);
+        if (SequenceGreaterThan(sequence, remote_sequence))
+        {
+            //slide the history so the previous newest sequence lands on bit shift - 1
+            uint32_t shift = sequence - remote_sequence;
+            if (shift < 32)
+                remote_ack_bits = (remote_ack_bits << shift) | (1u << (shift - 1));
+            else
+                remote_ack_bits = shift == 32 ? 1u << 31 : 0;
+            remote_sequence = sequence;
+        }
+        else if (sequence != remote_sequence)
+        {
+            //an older packet arriving late, mark it if it is still inside the history
+            uint32_t distance = remote_sequence - sequence;
+            if (distance <= 32)
+                remote_ack_bits |= 1u << (distance - 1);
+        }
+
+        if (recv_header.expect_ack)
+            ack_pending = true;
+    }
+
+    /**
+    * this function will check a message against the newest one of its action and entity, only state updates
+    * go through the channel, a message with the same sequence came in the same packet and is kept
+    * @param header                 - header of the message
+    * @return  bool                 - true if it is older than one already processed and has to be dropped
+    */
+    bool SequencedChannel::IsStale(net_header const& header)
+    {
+        net_action action = static_cast<net_action>(header.type);
+        if (action != net_action::NET_PLAYER_UPDATE && action != net_action::NET_ASTEROID_UPDATE)
+            return false;
+
+        uint64_t key = (static_cast<uint64_t>(static_cast<unsigned char>(header.type)) << 32) | static_cast<uint32_t>(header.id);
+        uint32_t sequence = static_cast<uint32_t>(header.sequence);
+
+        auto it = newest.find(key);
+        if (it == newest.end())
+        {
+            newest[key] = sequence;
+            return false;
+        }
+        if (SequenceGreaterThan(it->second, sequence))
+        {
+            discarded++;
+            return true;
         }
+        it->second = sequence;
+        return false;
     }
 }
 
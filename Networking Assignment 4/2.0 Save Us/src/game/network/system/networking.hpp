@@ -9,6 +9,10 @@
 
 #pragma once
 #include "utilsnetwork.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <queue>
@@ -50,8 +54,10 @@ namespace network {
         char        padding[1];
         int         sequence;
         int         id;
+        int         ack;            //newest sequence received from the other end
+        unsigned    ack_bits;       //bit n set if sequence ack - 1 - n was received too
     };
-    static_assert(sizeof(net_header) == 12);
+    static_assert(sizeof(net_header) == 20);
 
     //flg for the packet
     enum class net_flag
@@ -80,14 +86,143 @@ namespace network {
         NET_PLAYER_PRTCL_MOVE,
         NET_PLAYER_DISCONECTS,
         NET_GAME_OVER,
-        NET_GAME_WON
+        NET_GAME_WON,
+        NET_BUNDLE,             //several messages, each behind a net_msg_header
+        NET_ACK_ONLY            //no payload, sent with NET_ACK when there was nothing to piggyback the acks on
     };
 
+    //header of every message coalesced in a NET_BUNDLE packet
+    struct net_msg_header
+    {
+        char            type;
+        char            padding[1];
+        unsigned short  length;
+        int             id;
+    };
+    static_assert(sizeof(net_msg_header) == 8);
+
     //maximum amount of data a packet can send
     const unsigned  MAX_PAYLOAD_SIZE = 1024 - sizeof(net_header);
 
-    // used to allow reordering
-    using pair_timers_data = std::pair<float, std::vector<char>>;
+    //a received datagram split into header and payload, the payload points into the
+    //receive buffer so it is only valid until the next recvfrom on that socket
+    struct net_packet
+    {
+        net_header  header = {};
+        char*       msg = nullptr;
+        int         msg_length = 0;
+    };
+
+    /**
+    * this function will call process(header, msg, msg_length) for every message of a NET_BUNDLE packet, each one
+    * with a copy of the packet header carrying its own action and id, a truncated message ends the walk
+    * @param recv_header            - header of the packet
+    * @param msg                    - data of the packet
+    * @param data_length            - size of the data
+    * @param process                - function called for each message
+    * @return  void
+    */
+    template <typename F>
+    void UnpackBundle(net_header const& recv_header, char* msg, int data_length, F&& process)
+    {
+        int offset = 0;
+        while (offset + static_cast<int>(sizeof(net_msg_header)) <= data_length)
+        {
+            net_msg_header msg_header;
+            memcpy(&msg_header, msg + offset, sizeof(net_msg_header));
+            offset += sizeof(net_msg_header);
+            if (offset + msg_header.length > data_length)
+                break;
+
+            net_header header = recv_header;
+            header.type = msg_header.type;
+            header.id = msg_header.id;
+            process(header, msg + offset, static_cast<int>(msg_header.length));
+            offset += msg_header.length;
+        }
+    }
+
+    //sequence numbers wrap around, a is newer than b if it is less than half the range ahead of it
+    inline bool SequenceGreaterThan(uint32_t a, uint32_t b)
+    {
+        return static_cast<int32_t>(a - b) > 0;
+    }
+
+    //fixed size ring of entries indexed by sequence number, a slot only answers for the
+    //sequence that was last inserted in it so old entries are overwritten without a search,
+    //an entry that must not be lost is checked with IsValid on its slot before inserting
+    template <typename T, unsigned SIZE>
+    class SequenceBuffer
+    {
+    public:
+        T& Insert(uint32_t sequence)
+        {
+            unsigned index = sequence % SIZE;
+            sequences[index] = sequence;
+            valid[index] = true;
+            return entries[index];
+        }
+
+        T* Find(uint32_t sequence)
+        {
+            unsigned index = sequence % SIZE;
+            return valid[index] && sequences[index] == sequence ? &entries[index] : nullptr;
+        }
+
+        void Remove(uint32_t sequence)
+        {
+            unsigned index = sequence % SIZE;
+            if (sequences[index] == sequence)
+                valid[index] = false;
+        }
+
+        void Clear()
+        {
+            valid.fill(false);
+        }
+
+        //access by slot to walk every live entry
+        static constexpr unsigned Size() { return SIZE; }
+        static constexpr unsigned IndexOf(uint32_t sequence) { return sequence % SIZE; }
+        bool IsValid(unsigned index) const { return valid[index]; }
+        uint32_t SequenceAt(unsigned index) const { return sequences[index]; }
+        T& EntryAt(unsigned index) { return entries[index]; }
+
+    private:
+        std::array<uint32_t, SIZE>  sequences = {};
+        std::array<bool, SIZE>      valid = {};
+        std::array<T, SIZE>         entries = {};
+    };
+
+    //state sent every frame where only the newest copy matters, each action and entity keeps the newest
+    //sequence applied on a connection and anything older is dropped before the game sees it
+    class SequencedChannel
+    {
+    public:
+        //true if the message is on this channel and older than the last one accepted
+        bool IsStale(net_header const& header);
+        unsigned Discarded() const { return discarded; }
+
+    private:
+        std::unordered_map<uint64_t, uint32_t> newest;
+        unsigned discarded = 0;
+    };
+
+    //payload built once and sent to several clients, each only adds its own header
+    using shared_payload = std::shared_ptr<const std::vector<char>>;
+
+    //a sended packet waiting for acknowledge, the buffer keeps its capacity when the slot is reused,
+    //if the payload is shared the buffer only holds the header and the payload is kept by reference
+    struct net_sended_packet
+    {
+        float               timer = 0.0f;
+        std::vector<char>   data;
+        shared_payload      payload;
+    };
+
+    //slots in the ring of sended packets, every datagram takes a sequence so a packet can still be waiting
+    //for its ack when its slot comes round again, then it is resent and moved to a free slot instead of overwritten
+    const unsigned  SENDED_PACKETS_SIZE = 1024;
 
     //system tht has common operations between server and client
     class BaseNetwork
@@ -104,12 +239,49 @@ namespace network {
         sockaddr_in          m_remote_endpoint = {};
 
         //storage object for the packets sended that need acknowledge 
-        std::unordered_map<int, pair_timers_data> sended_packets;
+        SequenceBuffer<net_sended_packet, SENDED_PACKETS_SIZE> sended_packets;
+
+        //newest sequence received and the 32 before it, sent back in every header
+        uint32_t            remote_sequence = ~0u;
+        uint32_t            remote_ack_bits = 0;
+        bool                ack_pending = false;
 
-        //timers to check with
+        //timers to check with, acknowledge_timer is the resend timeout until the first round trip is measured
         std::chrono::nanoseconds alive_timer{ std::chrono::seconds(20) };
         std::chrono::nanoseconds acknowledge_timer{ std::chrono::seconds(2) };
+        std::chrono::nanoseconds ack_delay_timer{ std::chrono::milliseconds(100) };
+        std::chrono::nanoseconds min_rto_timer{ std::chrono::milliseconds(100) };
+        std::chrono::nanoseconds max_rto_timer{ std::chrono::seconds(2) };
         float current_alive_time = 0.0f;
+        float current_ack_time = 0.0f;
+
+        //round trip estimation from ack timing (Jacobson/Karels), in nanoseconds like the timers,
+        //the send time of every packet is kept so the ack naming it gives a sample
+        SequenceBuffer<std::chrono::steady_clock::time_point, SENDED_PACKETS_SIZE> sended_times;
+        float smoothed_rtt = 0.0f;
+        float rtt_variance = 0.0f;
+        float rto = 0.0f;
+
+        //the timeout doubles each time the oldest outstanding packet expires and backoff_sequence is the
+        //first sequence sent after the last doubling, only an ack from there on resets it
+        float rto_backoff = 1.0f;
+        uint32_t backoff_sequence = 0;
+
+        //most packets resent in one update, the rest wait for the next one
+        unsigned max_resends_per_update = 8;
+
+        //packets given up because every slot of the ring was waiting for an ack
+        unsigned lost_packets = 0;
+
+        //newest NET_PLAYER_UPDATE and NET_ASTEROID_UPDATE received per entity
+        SequencedChannel     sequenced;
+
+        //messages queued this frame with their sub-headers, flushed as NET_BUNDLE packets
+        std::vector<char>   reliable_msgs;
+        std::vector<char>   unreliable_msgs;
+
+        //every datagram read from m_socket lands here, reused for the whole session
+        std::array<char, MAX_PAYLOAD_SIZE + sizeof(net_header)> recv_buffer = {};
 
     public:
         virtual void Start(char const* ip, uint16_t port, bool debug = false) {}
@@ -119,8 +291,21 @@ namespace network {
         //------------------------------------FUNCTIONS----------------------------------------------
         net_header CreateHeader(net_flag flag, net_action action, bool expected_ack, int id, int sequence = 0);
         void UpdateSendedPackets();
-        void UnpackPacket(std::vector<char> packet, int data_length, net_header& recv_header, char* msg);
+        void ProcessAcks(net_header const& recv_header);
+        void UpdateRtt(float sample);
+        float RetransmitTimeout() const;
+        void PacketReceived(net_header const& recv_header);
+        bool UnpackPacket(char* packet, int data_length, net_packet& recv_packet);
         virtual void SendMsg(net_flag flag, net_action action,int id, int seq_num = 0, bool expected_acknowledge = true, const char* msg = nullptr, int size = 0);
+        void SendShared(net_flag flag, net_action action, int id, int seq_num, bool expected_acknowledge, shared_payload const& payload);
+        virtual void QueueMsg(net_action action, int id, bool expected_acknowledge = false, const char* msg = nullptr, int size = 0);
+        virtual void FlushMsgs();
+
+    protected:
+        void QueueInto(std::vector<char>& queue, bool expected_acknowledge, int sender, net_action action, int id, const char* msg, int size);
+        void FlushQueue(std::vector<char>& queue, bool expected_acknowledge, int sender);
+        net_sended_packet& InsertSended(uint32_t sequence);
+        void Relocate(unsigned index, unsigned reserved);
     };
 
 
@@ -132,6 +317,7 @@ namespace network {
 
         void Start(char const* ip, uint16_t port, bool mbserver, bool debug);
         bool Update();
+        void Flush();
         void ShutDown();
         BaseNetwork* system = nullptr;
         bool Im_server = false;
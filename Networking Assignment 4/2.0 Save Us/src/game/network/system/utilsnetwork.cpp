@@ -75,6 +75,31 @@ std::string ipv4_to_str(in_addr const& addr)
 	return std::string(remote_address);
 }
 
+/**
+ * @brief
+ *  Sends head and body as a single datagram without joining them first. Returns the bytes sent or SOCKET_ERROR
+ * @param s
+ * @param head
+ * @param head_size
+ * @param body
+ * @param body_size
+ * @param to
+ * @return int
+ */
+int sendto_parts(SOCKET s, char const* head, int head_size, char const* body, int body_size, sockaddr_in const& to)
+{
+	//the socket gathers both buffers into the datagram
+	WSABUF buffers[2] = {};
+	buffers[0].len = static_cast<ULONG>(head_size);
+	buffers[0].buf = const_cast<char*>(head);
+	buffers[1].len = static_cast<ULONG>(body_size);
+	buffers[1].buf = const_cast<char*>(body);
+
+	DWORD sent = 0;
+	int err = WSASendTo(s, buffers, body_size > 0 ? 2 : 1, &sent, 0, reinterpret_cast<sockaddr const*>(&to), sizeof(to), nullptr, nullptr);
+	return err == SOCKET_ERROR ? SOCKET_ERROR : static_cast<int>(sent);
+}
+
 
 
 #else
@@ -46,6 +46,19 @@ std::ostream& operator<<(std::ostream& os, in_addr const& ipv4);
  */
 in_addr cstr_to_ipv4(char const* str);
 
+/**
+ * @brief 
+ *  Sends head and body as a single datagram without joining them first. Returns the bytes sent or SOCKET_ERROR
+ * @param s 
+ * @param head 
+ * @param head_size 
+ * @param body 
+ * @param body_size 
+ * @param to 
+ * @return int 
+ */
+int sendto_parts(SOCKET s, char const* head, int head_size, char const* body, int body_size, sockaddr_in const& to);
+
 /**
  * @brief 
  *  Converts an address to an std::string
@@ -0,0 +1,101 @@
+/******************************************************************************/
+/*!
+\file		FragmentReassembler.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Client side of the FRAGMENT layer. Collects the fragments of a
+			message the server split (Server/Include/fragment.h documents
+			the layout) and hands back the whole message once the last one
+			arrives.
+
+			Every CMDID the server fragments is its own stream, with its own
+			message ids. Each stream reassembles in a fixed set of slots
+			allocated up front. A message that is still incomplete when a
+			newer one of the same stream needs its slot, or once a newer one
+			of that stream has completed, is dropped; other streams are
+			never touched.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#ifndef FRAGMENT_REASSEMBLER_H
+#define FRAGMENT_REASSEMBLER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Must match Server/Include/fragment.h
+const size_t FRAGMENT_MAX_DATAGRAM_SIZE = 1200;
+const size_t FRAGMENT_HEADER_SIZE = 4 + sizeof(uint8_t) + sizeof(uint32_t) + 2 * sizeof(uint8_t);
+const size_t FRAGMENT_PAYLOAD_SIZE = FRAGMENT_MAX_DATAGRAM_SIZE - FRAGMENT_HEADER_SIZE;
+const size_t FRAGMENT_MAX_COUNT = 32;
+
+class FragmentReassembler
+{
+public:
+	// streams: CMDIDs that can be reassembled; the server fragments
+	//          snapshots and asteroid updates
+	// slots:   messages of one stream collected at once
+	explicit FragmentReassembler(size_t streams = 2, size_t slots = 4);
+
+	// Feeds one FRAGMENT datagram. Returns true when it completes a message,
+	// which is then copied into message.
+	bool Add(const char* data, size_t size, std::vector<char>& message);
+
+	uint64_t FragmentsReceived() const { return _fragmentsReceived; }
+	// Duplicates, malformed fragments, fragments of stale messages and of
+	// streams beyond the ones there is room for
+	uint64_t FragmentsDiscarded() const { return _fragmentsDiscarded; }
+	uint64_t MessagesCompleted() const { return _messagesCompleted; }
+	// Incomplete messages given up on; each lost at least one fragment
+	uint64_t MessagesDropped() const { return _messagesDropped; }
+
+	// First fragment to last fragment, over completed messages
+	double AverageLatencyMs() const { return _messagesCompleted ? _totalLatencyMs / _messagesCompleted : 0.0; }
+	double MaxLatencyMs() const { return _maxLatencyMs; }
+
+private:
+	struct Slot
+	{
+		bool active = false;
+		uint32_t messageId = 0;
+		uint8_t count = 0;
+		uint8_t received = 0;
+		uint32_t receivedMask = 0;
+		size_t size = 0;
+		std::chrono::steady_clock::time_point firstArrival;
+		std::vector<char> bytes;
+	};
+
+	struct Stream
+	{
+		bool used = false;
+		uint8_t command = 0;
+		std::vector<Slot> slots;
+
+		// Newest message completed; anything at or before it is stale
+		uint32_t newestCompleted = 0;
+		bool anyCompleted = false;
+	};
+
+	// The stream for command, claiming a free one if it is new; null if
+	// every stream belongs to another command
+	Stream* FindStream(uint8_t command);
+
+	std::vector<Stream> _streams;
+
+	uint64_t _fragmentsReceived = 0;
+	uint64_t _fragmentsDiscarded = 0;
+	uint64_t _messagesCompleted = 0;
+	uint64_t _messagesDropped = 0;
+	double _totalLatencyMs = 0.0;
+	double _maxLatencyMs = 0.0;
+};
+
+#endif // FRAGMENT_REASSEMBLER_H
@@ -27,6 +27,9 @@ enum CMDID {
 	RECEIVE_ASTEROIDS = static_cast<unsigned char>(0x7),
 	SEND_BULLETS = static_cast<unsigned char>(0x8),
 	RECEIVE_BULLETS = static_cast<unsigned char>(0x9),
+	SNAPSHOT_DELTA = static_cast<unsigned char>(0xA),
+	FRAGMENT = static_cast<unsigned char>(0xB),
+	ASTEROID_HIT = static_cast<unsigned char>(0xC),
 
 	CMD_TEST = static_cast<unsigned char>(0x20),
 	ECHO_ERROR = static_cast<unsigned char>(0x30)
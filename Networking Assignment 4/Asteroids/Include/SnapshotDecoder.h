@@ -0,0 +1,53 @@
+/******************************************************************************/
+/*!
+\file		SnapshotDecoder.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Client side of the delta-compressed SNAPSHOT_DELTA stream. Keeps a
+			ring of the snapshots already rebuilt so a delta can be applied to
+			whichever baseline the server chose, and reports the newest
+			sequence for the client to acknowledge in SEND_PLAYERS.
+			The wire layout is documented in Server/Include/snapshot.h.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#ifndef SNAPSHOT_DECODER_H
+#define SNAPSHOT_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Main.h"
+
+class SnapshotDecoder
+{
+public:
+	explicit SnapshotDecoder(size_t history = 32);
+
+	// Rebuilds the snapshot in data into players (one per slot) and bullets
+	// (every player's bullets, in slot order). Returns false if the datagram is
+	// malformed, older than the newest applied, or its baseline is gone.
+	bool Decode(const char* data, size_t size, std::vector<Player>& players, std::vector<Bullet>& bullets);
+
+	// Newest snapshot applied; sent back to the server as the acknowledgement.
+	uint32_t AckSequence() const { return _ack; }
+
+private:
+	struct Decoded
+	{
+		uint32_t sequence = 0;
+		std::vector<Player> players;
+		std::vector<std::vector<Bullet>> bullets;
+	};
+
+	std::vector<Decoded> _ring;
+	uint32_t _ack = 0;
+};
+
+#endif // SNAPSHOT_DECODER_H
@@ -0,0 +1,234 @@
+/******************************************************************************/
+/*!
+\file		WireFormat.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Client copy of the quantized, bit-packed wire encoding for Player,
+			Bullet and asteroids. Must match Server/Include/wireformat.h
+			field for field; the layout and the reasoning behind each range
+			are documented there.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Main.h"
+
+// Appends values of 1..32 bits to a byte buffer, least significant bit first
+class BitWriter
+{
+public:
+	explicit BitWriter(std::vector<char>& out) : _out(out) {}
+
+	void Write(uint32_t value, unsigned bits)
+	{
+		_acc |= static_cast<uint64_t>(value & Mask(bits)) << _pending;
+		_pending += bits;
+		while (_pending >= 8)
+		{
+			_out.push_back(static_cast<char>(_acc & 0xFF));
+			_acc >>= 8;
+			_pending -= 8;
+		}
+	}
+
+	void WriteBool(bool value) { Write(value ? 1u : 0u, 1); }
+
+	// Pads the last partial byte with zeros; call once after the last field
+	void Flush()
+	{
+		if (_pending > 0)
+		{
+			_out.push_back(static_cast<char>(_acc & 0xFF));
+		}
+		_acc = 0;
+		_pending = 0;
+	}
+
+	static uint32_t Mask(unsigned bits)
+	{
+		return bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+	}
+
+private:
+	std::vector<char>& _out;
+	uint64_t _acc = 0;
+	unsigned _pending = 0;
+};
+
+// Reads what BitWriter wrote. A read past the end returns 0 and clears Ok()
+class BitReader
+{
+public:
+	BitReader(const char* data, size_t size) :
+		_ptr(reinterpret_cast<const uint8_t*>(data)),
+		_end(reinterpret_cast<const uint8_t*>(data) + size)
+	{
+	}
+
+	uint32_t Read(unsigned bits)
+	{
+		while (_pending < bits)
+		{
+			if (_ptr == _end)
+			{
+				_ok = false;
+				return 0;
+			}
+			_acc |= static_cast<uint64_t>(*_ptr++) << _pending;
+			_pending += 8;
+		}
+		uint32_t value = static_cast<uint32_t>(_acc) & BitWriter::Mask(bits);
+		_acc >>= bits;
+		_pending -= bits;
+		return value;
+	}
+
+	bool ReadBool() { return Read(1) != 0; }
+
+	bool Ok() const { return _ok; }
+
+private:
+	const uint8_t* _ptr;
+	const uint8_t* _end;
+	uint64_t _acc = 0;
+	unsigned _pending = 0;
+	bool _ok = true;
+};
+
+// A float mapped onto [min, max] in 2^bits - 1 even steps, clamped to the range
+struct QuantizedField
+{
+	float min;
+	float max;
+	unsigned bits;
+
+	uint32_t Quantize(float value) const
+	{
+		float t = (std::min(std::max(value, min), max) - min) / (max - min);
+		return static_cast<uint32_t>(t * static_cast<float>(BitWriter::Mask(bits)) + 0.5f);
+	}
+
+	float Dequantize(uint32_t q) const
+	{
+		return min + (max - min) * (static_cast<float>(q & BitWriter::Mask(bits)) / static_cast<float>(BitWriter::Mask(bits)));
+	}
+};
+
+struct WireFormat
+{
+	QuantizedField positionX{ -640.f, 640.f, 14 };
+	QuantizedField positionY{ -540.f, 540.f, 14 };
+	QuantizedField velocity{ -512.f, 512.f, 12 };
+	QuantizedField angle{ -3.14159265f, 3.14159265f, 11 };
+	QuantizedField size{ 0.f, 256.f, 8 };
+
+	unsigned playerIdBits = 8;
+	unsigned asteroidIdBits = 32;
+	unsigned bulletCountBits = 10;
+};
+
+const WireFormat WIRE_FORMAT = WireFormat();
+
+// One asteroid as the server sends it in RECEIVE_ASTEROIDS
+struct WireAsteroid
+{
+	int id;
+	bool active;
+	float size;
+	AEVec2 position;
+	AEVec2 velocity;
+	float rotation;
+};
+
+inline void WritePosition(BitWriter& out, const AEVec2& position)
+{
+	out.Write(WIRE_FORMAT.positionX.Quantize(position.x), WIRE_FORMAT.positionX.bits);
+	out.Write(WIRE_FORMAT.positionY.Quantize(position.y), WIRE_FORMAT.positionY.bits);
+}
+
+inline void WriteVelocity(BitWriter& out, const AEVec2& velocity)
+{
+	out.Write(WIRE_FORMAT.velocity.Quantize(velocity.x), WIRE_FORMAT.velocity.bits);
+	out.Write(WIRE_FORMAT.velocity.Quantize(velocity.y), WIRE_FORMAT.velocity.bits);
+}
+
+inline void WriteAngle(BitWriter& out, float radians)
+{
+	// Wrapped to [-pi, pi] so a ship that spun a few times still fits
+	out.Write(WIRE_FORMAT.angle.Quantize(std::remainder(radians, 6.28318531f)), WIRE_FORMAT.angle.bits);
+}
+
+inline void ReadPosition(BitReader& in, AEVec2& position)
+{
+	position.x = WIRE_FORMAT.positionX.Dequantize(in.Read(WIRE_FORMAT.positionX.bits));
+	position.y = WIRE_FORMAT.positionY.Dequantize(in.Read(WIRE_FORMAT.positionY.bits));
+}
+
+inline void ReadVelocity(BitReader& in, AEVec2& velocity)
+{
+	velocity.x = WIRE_FORMAT.velocity.Dequantize(in.Read(WIRE_FORMAT.velocity.bits));
+	velocity.y = WIRE_FORMAT.velocity.Dequantize(in.Read(WIRE_FORMAT.velocity.bits));
+}
+
+inline float ReadAngle(BitReader& in)
+{
+	return WIRE_FORMAT.angle.Dequantize(in.Read(WIRE_FORMAT.angle.bits));
+}
+
+// num_bullets is not part of Player on the wire; the bullet count goes in front
+// of the bullets instead
+inline void WritePlayer(BitWriter& out, const Player& player)
+{
+	out.Write(static_cast<uint32_t>(player.player_id), WIRE_FORMAT.playerIdBits);
+	out.WriteBool(player.shoot);
+	WritePosition(out, player.position);
+	WriteVelocity(out, player.velocity);
+	WriteAngle(out, player.direction);
+}
+
+inline void WriteBullet(BitWriter& out, const Bullet& bullet)
+{
+	out.Write(static_cast<uint32_t>(bullet.player_id), WIRE_FORMAT.playerIdBits);
+	WritePosition(out, bullet.position);
+}
+
+inline void WriteAsteroid(BitWriter& out, const WireAsteroid& asteroid)
+{
+	out.Write(static_cast<uint32_t>(asteroid.id), WIRE_FORMAT.asteroidIdBits);
+	out.WriteBool(asteroid.active);
+	out.Write(WIRE_FORMAT.size.Quantize(asteroid.size), WIRE_FORMAT.size.bits);
+	WritePosition(out, asteroid.position);
+	WriteVelocity(out, asteroid.velocity);
+	WriteAngle(out, asteroid.rotation);
+}
+
+inline void ReadBullet(BitReader& in, Bullet& bullet)
+{
+	bullet.player_id = static_cast<int>(in.Read(WIRE_FORMAT.playerIdBits));
+	ReadPosition(in, bullet.position);
+}
+
+inline void ReadAsteroid(BitReader& in, WireAsteroid& asteroid)
+{
+	asteroid.id = static_cast<int>(in.Read(WIRE_FORMAT.asteroidIdBits));
+	asteroid.active = in.ReadBool();
+	asteroid.size = WIRE_FORMAT.size.Dequantize(in.Read(WIRE_FORMAT.size.bits));
+	ReadPosition(in, asteroid.position);
+	ReadVelocity(in, asteroid.velocity);
+	asteroid.rotation = ReadAngle(in);
+}
+
+#endif // WIRE_FORMAT_H
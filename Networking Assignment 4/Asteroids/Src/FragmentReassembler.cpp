@@ -0,0 +1,165 @@
+/******************************************************************************/
+/*!
+\file		FragmentReassembler.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Client side of the FRAGMENT layer
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "FragmentReassembler.h"
+
+#include <cstring>
+
+FragmentReassembler::FragmentReassembler(size_t streams, size_t slots) :
+	_streams(streams)
+{
+	for (Stream& stream : _streams)
+	{
+		stream.slots.resize(slots);
+		for (Slot& slot : stream.slots)
+		{
+			slot.bytes.resize(FRAGMENT_MAX_COUNT * FRAGMENT_PAYLOAD_SIZE);
+		}
+	}
+}
+
+FragmentReassembler::Stream* FragmentReassembler::FindStream(uint8_t command)
+{
+	Stream* unused = nullptr;
+	for (Stream& stream : _streams)
+	{
+		if (stream.used && stream.command == command)
+		{
+			return &stream;
+		}
+		if (!stream.used && unused == nullptr)
+		{
+			unused = &stream;
+		}
+	}
+	if (unused != nullptr)
+	{
+		unused->used = true;
+		unused->command = command;
+	}
+	return unused;
+}
+
+bool FragmentReassembler::Add(const char* data, size_t size, std::vector<char>& message)
+{
+	++_fragmentsReceived;
+
+	uint8_t command;
+	uint32_t messageId;
+	uint8_t index;
+	uint8_t count;
+	if (size <= FRAGMENT_HEADER_SIZE)
+	{
+		++_fragmentsDiscarded;
+		return false;
+	}
+	const char* field = data + 4;
+	memcpy(&command, field, sizeof(command));
+	field += sizeof(command);
+	memcpy(&messageId, field, sizeof(messageId));
+	field += sizeof(messageId);
+	memcpy(&index, field, sizeof(index));
+	field += sizeof(index);
+	memcpy(&count, field, sizeof(count));
+
+	size_t payload = size - FRAGMENT_HEADER_SIZE;
+	bool last = index + 1 == count;
+	if (count == 0 || count > FRAGMENT_MAX_COUNT || index >= count ||
+		payload > FRAGMENT_PAYLOAD_SIZE || (!last && payload != FRAGMENT_PAYLOAD_SIZE))
+	{
+		++_fragmentsDiscarded;
+		return false;
+	}
+
+	Stream* stream = FindStream(command);
+	if (stream == nullptr)
+	{
+		++_fragmentsDiscarded;
+		return false;
+	}
+
+	// Ids only grow (wrapping) within a stream, so an id at or before the
+	// newest completed message belongs to one that has been superseded.
+	if (stream->anyCompleted && static_cast<int32_t>(messageId - stream->newestCompleted) <= 0)
+	{
+		++_fragmentsDiscarded;
+		return false;
+	}
+
+	Slot& slot = stream->slots[messageId % stream->slots.size()];
+	if (!slot.active || slot.messageId != messageId)
+	{
+		if (slot.active)
+		{
+			if (static_cast<int32_t>(messageId - slot.messageId) < 0)
+			{
+				// An older message than the one already collecting here
+				++_fragmentsDiscarded;
+				return false;
+			}
+			++_messagesDropped;
+		}
+		slot.active = true;
+		slot.messageId = messageId;
+		slot.count = count;
+		slot.received = 0;
+		slot.receivedMask = 0;
+		slot.size = 0;
+		slot.firstArrival = std::chrono::steady_clock::now();
+	}
+
+	uint32_t bit = 1u << index;
+	if (count != slot.count || (slot.receivedMask & bit))
+	{
+		++_fragmentsDiscarded;
+		return false;
+	}
+
+	memcpy(slot.bytes.data() + index * FRAGMENT_PAYLOAD_SIZE, data + FRAGMENT_HEADER_SIZE, payload);
+	slot.receivedMask |= bit;
+	++slot.received;
+	if (last)
+	{
+		slot.size = index * FRAGMENT_PAYLOAD_SIZE + payload;
+	}
+
+	if (slot.received != slot.count)
+	{
+		return false;
+	}
+
+	message.assign(slot.bytes.begin(), slot.bytes.begin() + slot.size);
+	slot.active = false;
+
+	double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - slot.firstArrival).count();
+	_totalLatencyMs += latencyMs;
+	if (latencyMs > _maxLatencyMs)
+	{
+		_maxLatencyMs = latencyMs;
+	}
+	++_messagesCompleted;
+
+	// Anything older of this stream still collecting can never be used now
+	for (Slot& other : stream->slots)
+	{
+		if (other.active && static_cast<int32_t>(other.messageId - messageId) < 0)
+		{
+			other.active = false;
+			++_messagesDropped;
+		}
+	}
+	stream->newestCompleted = messageId;
+	stream->anyCompleted = true;
+	return true;
+}
@@ -12,11 +12,17 @@ prior written consent of DigiPen Institute of Technology is prohibited.
  */
  /******************************************************************************/
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #include "AtomicVariables.h"
+#include "FragmentReassembler.h"
 #include "PathSmoother.h"
+#include "SnapshotDecoder.h"
+#include "WireFormat.h"
 #include "main.h"
 
 /******************************************************************************/
@@ -58,6 +64,12 @@ const int			ASTEROID_START			= 0;			// 2 second spawn time for asteroids
 //FOR LIVES PICKUP
 const float			LIVES_SIZE				= 30.0f;		// lives pickup size
 
+
+//FOR ASTEROID HIT CLAIMS
+const double		HIT_LAG_COMPENSATION	= 0.5;			// how far back the server rewinds a claim (its LAG_COMPENSATION_SECONDS)
+const double		HIT_CONFIRM_DEFAULT		= 0.25;			// seconds assumed for the server to drop a hit asteroid until one is seen
+const double		HIT_RESEND_INTERVAL		= 0.1;			// seconds between copies of a claim the server has not settled
+
 // -----------------------------------------------------------------------------
 enum TYPE
 {
@@ -106,12 +118,6 @@ struct GameObjInst
 	int					id;
 };
 
-// Asteroid
-struct NetworkAsteroid {
-	AEVec2 position;
-	AEVec2 velocity;
-	float  direction;
-};
 /******************************************************************************/
 /*!
 	Static Variables
@@ -168,6 +174,30 @@ std::vector<GameObjInst*> player_list;
 std::vector<GameObjInst*> asteroids_list;
 std::vector<GameObjInst*> bullet_list;
 
+// Asteroids this client shot down and claimed with ASTEROID_HIT. The claim
+// is repeated by the network thread until the id leaves the server's field;
+// the game loop keeps the asteroid hidden meanwhile and settles the claim.
+struct AsteroidHit
+{
+	int id;
+	AEVec2 position;	// where the bullet was when it hit
+	std::chrono::steady_clock::time_point hit_time;
+	std::chrono::steady_clock::time_point sent_time;	// last copy sent, none yet if default
+};
+static std::mutex hit_claims_mutex;
+static std::vector<AsteroidHit> hit_claims;
+// Smoothed time from a hit to the server's field dropping the asteroid:
+// a round trip plus the wait for the next RECEIVE_ASTEROIDS. Game loop only.
+static double hit_confirm_time = HIT_CONFIRM_DEFAULT;
+
+// The newest RECEIVE_ASTEROIDS field, decoded by the network thread and
+// applied by the game loop; an older field not yet applied is replaced.
+static std::mutex received_asteroids_mutex;
+static std::vector<WireAsteroid> received_asteroids;
+static bool received_asteroids_ready = false;
+
+static void ApplyReceivedAsteroids(const std::vector<WireAsteroid>& receivedAsteroids);
+
 /******************************************************************************/
 /*!
 	"Load" function of this state
@@ -326,11 +356,32 @@ void GameStateAsteroidsUpdate(void)
 	{
 		asteroid_timer -= ASTEROID_TIME;
 
-		spawnAsteroid(2);
+		// in multiplayer the server spawns asteroids and broadcasts them
+		if (!av_connected)
+		{
+			spawnAsteroid(2);
+		}
 
 		spawnLives(1);
 	}
 
+	// mirror the newest asteroid field the network thread decoded
+	std::vector<WireAsteroid> receivedAsteroids;
+	bool asteroidsReceived = false;
+	{
+		std::lock_guard<std::mutex> lock(received_asteroids_mutex);
+		if (received_asteroids_ready)
+		{
+			receivedAsteroids.swap(received_asteroids);
+			received_asteroids_ready = false;
+			asteroidsReceived = true;
+		}
+	}
+	if (asteroidsReceived)
+	{
+		ApplyReceivedAsteroids(receivedAsteroids);
+	}
+
 	// =========================
 	// update according to input
 	// =========================
@@ -635,6 +686,14 @@ void GameStateAsteroidsUpdate(void)
 								return bullet == pInst;
 							}), bullet_list.end());
 
+						// The server confirms the hit against where the asteroid
+						// was when this client saw it, then removes it for everyone
+						if (av_connected)
+						{
+							std::lock_guard<std::mutex> lock(hit_claims_mutex);
+							hit_claims.push_back({ pInst->id, pOther->posCurr, std::chrono::steady_clock::now(), {} });
+						}
+
 						// Disable bullet and asteroid
 						gameObjInstDestroy(pOther);
 						gameObjInstDestroy(pInst);
@@ -1101,6 +1160,139 @@ void spawnLives(unsigned int count)
 	}
 }
 
+/******************************************************************************/
+/*!
+	Apply one snapshot's worth of player state to the remote ships
+*/
+/******************************************************************************/
+static void ApplyReceivedPlayers(const std::vector<Player>& receivedplayer)
+{
+	for (int i{}; i < player_list.size() && i < receivedplayer.size(); ++i)
+	{
+		if (player_list[i] == nullptr) continue;
+		player_list[i]->id = receivedplayer[i].player_id;
+		player_list[i]->posCurr = receivedplayer[i].position;
+		player_list[i]->velCurr = receivedplayer[i].velocity;
+		player_list[i]->dirCurr = receivedplayer[i].direction;
+		newPathData temp;
+		temp.newPosition = player_list[i]->posCurr;
+		temp.newVelocity = player_list[i]->velCurr;
+		temp.newDir = player_list[i]->dirCurr;
+		pathData.push_back(std::make_pair(i,temp));
+
+		if (receivedplayer[i].shoot) {
+			for (GameObjInst* player : player_list) {
+				if (player == nullptr) continue;
+				// Temp storage for new bullet, spawned  ship pos
+				AEVec2 added;
+
+				// Get the bullet's direction according to the ship's direction
+				AEVec2Set(&added, cosf(player->dirCurr), sinf(player->dirCurr));
+				AEVec2Normalize(&added, &added);
+
+				// Set the velocity
+				AEVec2Scale(&added, &added, BULLET_SPEED);
+				bullet_list.emplace_back(gameObjInstCreate(TYPE_BULLET, BULLET_SIZE, &player->posCurr, &added, player->dirCurr));
+			}
+		}
+	}
+}
+
+/******************************************************************************/
+/*!
+	Mirror the server's asteroid field. A claimed asteroid the field no
+	longer carries was confirmed. One it still carries stays hidden for
+	about a round trip plus the server's rewind window, after which the
+	claim was rejected or every copy lost and the asteroid comes back.
+	Asteroids the server no longer sends are destroyed. Game loop only; it
+	creates and destroys instances the update and collision passes walk.
+*/
+/******************************************************************************/
+static void ApplyReceivedAsteroids(const std::vector<WireAsteroid>& receivedAsteroids)
+{
+	auto now = std::chrono::steady_clock::now();
+	std::vector<GameObjInst*> current;
+	current.reserve(receivedAsteroids.size());
+
+	std::lock_guard<std::mutex> lock(hit_claims_mutex);
+	hit_claims.erase(std::remove_if(hit_claims.begin(), hit_claims.end(), [&](const AsteroidHit& claim)
+		{
+			bool inField = std::any_of(receivedAsteroids.begin(), receivedAsteroids.end(), [&claim](const WireAsteroid& asteroid)
+				{
+					return asteroid.id == claim.id;
+				});
+			if (!inField)
+			{
+				double sample = std::chrono::duration<double>(now - claim.hit_time).count();
+				hit_confirm_time += (sample - hit_confirm_time) / 8.0;
+			}
+			return !inField;
+		}), hit_claims.end());
+	std::chrono::duration<double> hideFor(hit_confirm_time + HIT_LAG_COMPENSATION);
+
+	for (const WireAsteroid& asteroid : receivedAsteroids)
+	{
+		auto claim = std::find_if(hit_claims.begin(), hit_claims.end(), [&asteroid](const AsteroidHit& hit)
+			{
+				return hit.id == asteroid.id;
+			});
+		if (claim != hit_claims.end())
+		{
+			if (now - claim->hit_time < hideFor)
+			{
+				continue;
+			}
+			hit_claims.erase(claim);
+			if (sScore >= static_cast<unsigned long>(ASTEROID_SCORE))
+			{
+				sScore -= ASTEROID_SCORE;
+			}
+		}
+
+		auto existing = std::find_if(asteroids_list.begin(), asteroids_list.end(), [&asteroid](GameObjInst* pInst)
+			{
+				return pInst->id == asteroid.id;
+			});
+
+		if (existing != asteroids_list.end() && ((*existing)->flag & FLAG_ACTIVE) && (*existing)->pObject->type == TYPE_ASTEROID)
+		{
+			GameObjInst* pInst = *existing;
+			pInst->posCurr = asteroid.position;
+			pInst->velCurr = asteroid.velocity;
+			current.push_back(pInst);
+		}
+		else
+		{
+			// New, or destroyed here without the server agreeing
+			AEVec2 pos = asteroid.position;
+			AEVec2 vel = asteroid.velocity;
+			GameObjInst* pInst = gameObjInstCreate(TYPE_ASTEROID, asteroid.size, &pos, &vel, asteroid.rotation);
+			if (pInst != nullptr)
+			{
+				pInst->id = asteroid.id;
+				current.push_back(pInst);
+			}
+		}
+	}
+
+	// Anything left over has expired on the server
+	for (GameObjInst* pInst : asteroids_list)
+	{
+		if (std::find(current.begin(), current.end(), pInst) == current.end() &&
+			(pInst->flag & FLAG_ACTIVE) && pInst->pObject->type == TYPE_ASTEROID)
+		{
+			gameObjInstDestroy(pInst);
+		}
+	}
+	asteroids_list.swap(current);
+}
+
+// Rebuilds SNAPSHOT_DELTA datagrams; its ack rides on every SEND_PLAYERS
+static SnapshotDecoder snapshot_decoder;
+// Joins FRAGMENT datagrams back into the snapshot or asteroid update they split
+static FragmentReassembler fragment_reassembler;
+static std::vector<char> reassembled_buffer;
+
 void AsteroidsDataTransfer(SOCKET udp_socket)
 {
 	BOOL bOptVal = TRUE;
@@ -1154,12 +1346,24 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 			//bullets[i].position = bullet_list[i]->posCurr;
 		}
 
+		// The ack tells the server which snapshot to diff the next one against
 		CMDID send_id = SEND_PLAYERS;
-		size_t dataSize = sizeof(Player) + (sizeof(Bullet) * num_bullets) + sizeof(send_id);
-		std::vector<char> buffer(dataSize);
+		uint32_t ack = snapshot_decoder.AckSequence();
+		size_t headerSize = sizeof(send_id) + sizeof(ack);
+		std::vector<char> buffer(headerSize);
 		memcpy(buffer.data(), &send_id, sizeof(send_id));
-		memcpy(buffer.data() + sizeof(send_id), player.data(), sizeof(Player));
-		memcpy(buffer.data() + sizeof(send_id) + sizeof(Player), bullets.data(), sizeof(Bullet) * num_bullets);
+		memcpy(buffer.data() + sizeof(send_id), &ack, sizeof(ack));
+
+		// Player, bullet count and bullets are bit-packed after the header
+		BitWriter bits(buffer);
+		WritePlayer(bits, player[0]);
+		bits.Write(static_cast<uint32_t>(num_bullets), WIRE_FORMAT.bulletCountBits);
+		for (int i{}; i < num_bullets; ++i)
+		{
+			WriteBullet(bits, bullets[i]);
+		}
+		bits.Flush();
+		size_t dataSize = buffer.size();
 
 		if (sendto(udp_socket, buffer.data(), dataSize, 0, (SOCKADDR*)&broadcastAddr, sizeof(broadcastAddr)) == SOCKET_ERROR)
 		{
@@ -1169,6 +1373,40 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 			return;
 		}
 
+		// One ASTEROID_HIT per open claim: CMDID, uint32 asteroid id, then the
+		// bullet's position bit-packed. Claims stay open until the game loop
+		// settles them, so a lost copy is covered by the next one.
+		std::vector<AsteroidHit> hits;
+		{
+			std::lock_guard<std::mutex> lock(hit_claims_mutex);
+			auto now = std::chrono::steady_clock::now();
+			for (AsteroidHit& claim : hit_claims)
+			{
+				if (std::chrono::duration<double>(now - claim.sent_time).count() >= HIT_RESEND_INTERVAL)
+				{
+					claim.sent_time = now;
+					hits.push_back(claim);
+				}
+			}
+		}
+		for (const AsteroidHit& hit : hits)
+		{
+			CMDID hit_id = ASTEROID_HIT;
+			uint32_t asteroid_id = static_cast<uint32_t>(hit.id);
+			std::vector<char> hit_buffer(sizeof(hit_id) + sizeof(asteroid_id));
+			memcpy(hit_buffer.data(), &hit_id, sizeof(hit_id));
+			memcpy(hit_buffer.data() + sizeof(hit_id), &asteroid_id, sizeof(asteroid_id));
+
+			BitWriter hit_bits(hit_buffer);
+			WritePosition(hit_bits, hit.position);
+			hit_bits.Flush();
+
+			if (sendto(udp_socket, hit_buffer.data(), static_cast<int>(hit_buffer.size()), 0, (SOCKADDR*)&broadcastAddr, sizeof(broadcastAddr)) == SOCKET_ERROR)
+			{
+				std::cerr << "sendto ASTEROID_HIT failed with error: " << WSAGetLastError() << '\n';
+			}
+		}
+
 		// Receive the response from the server
 		sockaddr_in serverAddr;
 		int serverAddrSize = sizeof(serverAddr);
@@ -1181,9 +1419,22 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 		std::vector<char> receive_buffer(data_size);
 		int bytesReceived = recvfrom(udp_socket, receive_buffer.data(), data_size, 0, (SOCKADDR*)&serverAddr, &serverAddrSize);
 
-		if (bytesReceived != SOCKET_ERROR) {
-			char* bufferPtr = receive_buffer.data();
+		if (bytesReceived != SOCKET_ERROR && bytesReceived >= static_cast<int>(sizeof(receive_id))) {
 			memcpy(&receive_id, receive_buffer.data(), sizeof(receive_id));
+			if (receive_id == FRAGMENT)
+			{
+				if (!fragment_reassembler.Add(receive_buffer.data(), bytesReceived, reassembled_buffer) ||
+					reassembled_buffer.size() < sizeof(receive_id))
+				{
+					continue;
+				}
+				// Carry on as if the whole message had arrived in one datagram
+				receive_buffer.swap(reassembled_buffer);
+				bytesReceived = static_cast<int>(receive_buffer.size());
+				memcpy(&receive_id, receive_buffer.data(), sizeof(receive_id));
+			}
+
+			char* bufferPtr = receive_buffer.data();
 			bufferPtr += sizeof(receive_id);
 			newDataReceived = true;
 			switch (receive_id)
@@ -1191,35 +1442,7 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 			case SEND_PLAYERS: {
 				std::vector<Player> receivedplayer(av_player_max);
 				memcpy(receivedplayer.data(), receive_buffer.data() + sizeof(receive_id), av_player_max * sizeof(Player));
-				for (int i{}; i < player_list.size(); ++i)
-				{
-					if (player_list[i] == nullptr) continue;
-					player_list[i]->id = receivedplayer[i].player_id;
-					player_list[i]->posCurr = receivedplayer[i].position;
-					player_list[i]->velCurr = receivedplayer[i].velocity;
-					player_list[i]->dirCurr = receivedplayer[i].direction;
-					newPathData temp;
-					temp.newPosition = player_list[i]->posCurr;
-					temp.newVelocity = player_list[i]->velCurr;
-					temp.newDir = player_list[i]->dirCurr;
-					pathData.push_back(std::make_pair(i,temp));
-
-					if (receivedplayer[i].shoot) {
-						for (GameObjInst* player : player_list) {
-							if (player == nullptr) continue;
-							// Temp storage for new bullet, spawned  ship pos
-							AEVec2 added;
-
-							// Get the bullet's direction according to the ship's direction
-							AEVec2Set(&added, cosf(player->dirCurr), sinf(player->dirCurr));
-							AEVec2Normalize(&added, &added);
-
-							// Set the velocity
-							AEVec2Scale(&added, &added, BULLET_SPEED);
-							bullet_list.emplace_back(gameObjInstCreate(TYPE_BULLET, BULLET_SIZE, &player->posCurr, &added, player->dirCurr));
-						}
-					}
-				}
+				ApplyReceivedPlayers(receivedplayer);
 				bufferPtr += av_player_max * sizeof(Player);
 				std::vector<Bullet> receivedBullets;
 				while (bufferPtr < receive_buffer.data() + bytesReceived) {
@@ -1231,32 +1454,39 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 
 				break;
 			}
-			case SEND_ASTEROIDS : {
-				if (!asteroids_list.empty())
+			case SNAPSHOT_DELTA: {
+				std::vector<Player> receivedplayer;
+				std::vector<Bullet> receivedBullets;
+				if (snapshot_decoder.Decode(receive_buffer.data(), bytesReceived, receivedplayer, receivedBullets))
 				{
-					CMDID asteroid_cmd = SEND_ASTEROIDS;
-					size_t asteroid_count = asteroids_list.size();
-					std::vector<NetworkAsteroid> asteroid_data(asteroid_count);
-
-					for (size_t i = 0; i < asteroid_count; ++i)
-					{
-						if (asteroids_list[i] == nullptr) continue;
-						asteroid_data[i].position = asteroids_list[i]->posCurr;
-						asteroid_data[i].velocity = asteroids_list[i]->velCurr;
-						asteroid_data[i].direction = asteroids_list[i]->dirCurr;
-					}
-
-					size_t asteroid_data_size = sizeof(asteroid_cmd) + sizeof(NetworkAsteroid) * asteroid_count;
-					std::vector<char> asteroid_buffer(asteroid_data_size);
-
-					memcpy(asteroid_buffer.data(), &asteroid_cmd, sizeof(asteroid_cmd));
-					memcpy(asteroid_buffer.data() + sizeof(asteroid_cmd), asteroid_data.data(), sizeof(NetworkAsteroid) * asteroid_count);
+					ApplyReceivedPlayers(receivedplayer);
+				}
+				break;
+			}
+			case RECEIVE_ASTEROIDS: {
+				// uint16 count, then the asteroids bit-packed
+				uint16_t asteroid_count;
+				if (bytesReceived < static_cast<int>(sizeof(receive_id) + sizeof(asteroid_count)))
+				{
+					break;
+				}
+				memcpy(&asteroid_count, bufferPtr, sizeof(asteroid_count));
+				bufferPtr += sizeof(asteroid_count);
 
-					if (sendto(udp_socket, asteroid_buffer.data(), asteroid_data_size, 0, (SOCKADDR*)&broadcastAddr, sizeof(broadcastAddr)) == SOCKET_ERROR)
-					{
-						std::cerr << "sendto ASTEROIDS failed with error: " << WSAGetLastError() << '\n';
-					}
+				BitReader bits(bufferPtr, receive_buffer.data() + bytesReceived - bufferPtr);
+				std::vector<WireAsteroid> receivedAsteroids(asteroid_count);
+				for (uint16_t i = 0; i < asteroid_count; ++i)
+				{
+					ReadAsteroid(bits, receivedAsteroids[i]);
 				}
+				if (bits.Ok())
+				{
+					// Instances belong to the game loop, which applies this next frame
+					std::lock_guard<std::mutex> lock(received_asteroids_mutex);
+					received_asteroids.swap(receivedAsteroids);
+					received_asteroids_ready = true;
+				}
+				break;
 			}
 
 			case SEND_BULLETS: {
@@ -1290,10 +1520,38 @@ void AsteroidsDataTransfer(SOCKET udp_socket)
 			}
 		}
 	}
+
+	std::cout << "Fragments received=" << fragment_reassembler.FragmentsReceived()
+		<< " discarded=" << fragment_reassembler.FragmentsDiscarded()
+		<< " messages reassembled=" << fragment_reassembler.MessagesCompleted()
+		<< " dropped=" << fragment_reassembler.MessagesDropped()
+		<< " latency avg=" << fragment_reassembler.AverageLatencyMs()
+		<< "ms max=" << fragment_reassembler.MaxLatencyMs() << "ms\n";
 }
 
 void initMultiPlayer(int num_player)
 {
+	// the server owns the asteroid field; drop the ones spawned for single player
+	for (unsigned long i = 0; i < GAME_OBJ_INST_NUM_MAX; ++i)
+	{
+		GameObjInst* pInst = sGameObjInstList + i;
+		if ((pInst->flag & FLAG_ACTIVE) && pInst->pObject->type == TYPE_ASTEROID)
+		{
+			gameObjInstDestroy(pInst);
+		}
+	}
+	asteroids_list.clear();
+	{
+		std::lock_guard<std::mutex> lock(hit_claims_mutex);
+		hit_claims.clear();
+		hit_confirm_time = HIT_CONFIRM_DEFAULT;
+	}
+	{
+		std::lock_guard<std::mutex> lock(received_asteroids_mutex);
+		received_asteroids.clear();
+		received_asteroids_ready = false;
+	}
+
 	player_list.resize(num_player);
 	for(int i {}; i < num_player; ++i)
 	{
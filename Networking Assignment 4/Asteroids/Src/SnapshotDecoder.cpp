@@ -0,0 +1,147 @@
+/******************************************************************************/
+/*!
+\file		SnapshotDecoder.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Client side of the delta-compressed SNAPSHOT_DELTA stream
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "SnapshotDecoder.h"
+
+#include <cstring>
+
+#include "WireFormat.h"
+
+namespace
+{
+	// Field mask bits, matching SnapshotField on the server
+	const uint8_t SF_PLAYER_ID = 0x01;
+	const uint8_t SF_SHOOT = 0x02;
+	const uint8_t SF_POSITION = 0x04;
+	const uint8_t SF_VELOCITY = 0x08;
+	const uint8_t SF_DIRECTION = 0x10;
+	const uint8_t SF_BULLETS = 0x20;
+	const unsigned FIELD_MASK_BITS = 6;
+
+	// Bounds-checked reader over the byte-aligned header
+	struct Reader
+	{
+		const char* ptr;
+		const char* end;
+
+		template <typename T>
+		bool Read(T& value)
+		{
+			if (end - ptr < static_cast<ptrdiff_t>(sizeof(T))) return false;
+			memcpy(&value, ptr, sizeof(T));
+			ptr += sizeof(T);
+			return true;
+		}
+	};
+}
+
+SnapshotDecoder::SnapshotDecoder(size_t history) :
+	_ring(history)
+{
+}
+
+bool SnapshotDecoder::Decode(const char* data, size_t size, std::vector<Player>& players, std::vector<Bullet>& bullets)
+{
+	Reader in{ data, data + size };
+
+	CMDID id;
+	uint32_t sequence = 0;
+	uint32_t baselineSequence = 0;
+	uint8_t playerCount = 0;
+	if (!in.Read(id) || id != SNAPSHOT_DELTA ||
+		!in.Read(sequence) || !in.Read(baselineSequence) || !in.Read(playerCount))
+	{
+		return false;
+	}
+
+	// Late or duplicated datagram; a newer snapshot is already applied.
+	if (sequence <= _ack)
+	{
+		return false;
+	}
+
+	const Decoded* baseline = nullptr;
+	if (baselineSequence != 0)
+	{
+		const Decoded& slot = _ring[baselineSequence % _ring.size()];
+		if (slot.sequence != baselineSequence)
+		{
+			return false;
+		}
+		baseline = &slot;
+	}
+
+	Decoded& target = _ring[sequence % _ring.size()];
+	// The baseline may live in the slot being overwritten; rebuild into temporaries.
+	std::vector<Player> nextPlayers(playerCount, Player{});
+	std::vector<std::vector<Bullet>> nextBullets(playerCount);
+
+	// Everything after the header is bit-packed
+	BitReader bits(in.ptr, static_cast<size_t>(in.end - in.ptr));
+
+	for (uint8_t i = 0; i < playerCount; ++i)
+	{
+		Player& player = nextPlayers[i];
+		std::vector<Bullet>& playerBullets = nextBullets[i];
+		if (baseline && i < baseline->players.size())
+		{
+			player = baseline->players[i];
+			playerBullets = baseline->bullets[i];
+		}
+
+		uint32_t mask = bits.Read(FIELD_MASK_BITS);
+
+		if (mask & SF_PLAYER_ID)	player.player_id = static_cast<int>(bits.Read(WIRE_FORMAT.playerIdBits));
+		if (mask & SF_SHOOT)		player.shoot = bits.ReadBool();
+		if (mask & SF_POSITION)		ReadPosition(bits, player.position);
+		if (mask & SF_VELOCITY)		ReadVelocity(bits, player.velocity);
+		if (mask & SF_DIRECTION)	player.direction = ReadAngle(bits);
+
+		if (mask & SF_BULLETS)
+		{
+			uint32_t count = bits.Read(WIRE_FORMAT.bulletCountBits);
+
+			// One bit per bullet; set if it is new or moved since the baseline
+			std::vector<bool> changed(count);
+			for (uint32_t b = 0; b < count; ++b)
+			{
+				changed[b] = bits.ReadBool();
+			}
+
+			playerBullets.resize(count);
+			for (uint32_t b = 0; b < count; ++b)
+			{
+				if (changed[b])
+				{
+					ReadBullet(bits, playerBullets[b]);
+				}
+			}
+		}
+		if (!bits.Ok()) return false;
+		player.num_bullets = static_cast<int>(playerBullets.size());
+	}
+
+	target.sequence = sequence;
+	target.players.swap(nextPlayers);
+	target.bullets.swap(nextBullets);
+	_ack = sequence;
+
+	players = target.players;
+	bullets.clear();
+	for (const std::vector<Bullet>& playerBullets : target.bullets)
+	{
+		bullets.insert(bullets.end(), playerBullets.begin(), playerBullets.end());
+	}
+	return true;
+}
@@ -0,0 +1,507 @@
+/******************************************************************************/
+/*!
+\file		loadgen.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Headless load generator for the UDP server. Each simulated
+			client has its own socket, performs the handshake ("Hello,
+			server!", player number reply, start signal) and then streams
+			scripted SEND_PLAYERS at a fixed rate, acking the newest
+			snapshot it has seen like the real client does.
+
+			Usage: loadgen [--server <ip>] [--port <port>] [--clients <n>]
+			               [--rate <hz>] [--duration <seconds>] [--bullets <n>]
+
+			Latency is input to snapshot: every input moves the client's ship
+			by one quantization step, so the position a snapshot carries
+			names the input it reflects. Loss is counted from gaps in the
+			snapshot sequence, which also includes snapshots the server
+			held back for a client over its send budget.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "netplatform.h"
+#include "server.h"
+#include "snapshot.h"
+#include "wireformat.h"
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	const char HANDSHAKE_MESSAGE[] = "Hello, server!";
+	// Handshakes unanswered for this long are sent again
+	const auto HANDSHAKE_RETRY = std::chrono::seconds(1);
+	// How long to wait for every match to start before measuring anyway
+	const auto START_TIMEOUT = std::chrono::seconds(5);
+	const int PLAYERS_PER_MATCH = 4;
+
+	// Inputs whose send time is remembered; each gets its own quantized x
+	const uint32_t LATENCY_WINDOW = 1024;
+	// First quantized x used, well inside the encodable range
+	const uint32_t LATENCY_BASE_X = 4096;
+
+	const size_t RECEIVE_SIZE = 4096;
+
+	struct Options
+	{
+		std::string server = "127.0.0.1";
+		uint16_t port = 9000;
+		int clients = 400;
+		double rate = 60.0;
+		double duration = 10.0;
+		int bullets = 0;
+	};
+
+	enum class State
+	{
+		HANDSHAKE,	// waiting for the player number
+		SEATED,		// waiting for the match to fill
+		PLAYING
+	};
+
+	struct Counts
+	{
+		uint64_t inputs = 0;
+		uint64_t snapshots = 0;
+		uint64_t asteroids = 0;
+		uint64_t fragments = 0;
+		uint64_t other = 0;
+		uint64_t bytes = 0;
+		uint64_t gaps = 0;		// sequences skipped between two snapshots
+		uint64_t stale = 0;		// snapshots no newer than one already seen
+	};
+
+	struct Client
+	{
+		SOCKET socket = INVALID_SOCKET;
+		State state = State::HANDSHAKE;
+		int player_index = -1;
+		clock_type::time_point handshake_sent;
+		clock_type::time_point next_send;
+
+		uint32_t input = 0;
+		uint32_t newest_sequence = 0;
+		// Send time of each input still in the window; zero once matched
+		std::vector<clock_type::time_point> sent_at = std::vector<clock_type::time_point>(LATENCY_WINDOW);
+		Counts counts;
+	};
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg(argv[i]);
+			if (i + 1 >= argc)
+			{
+				return false;
+			}
+			if (arg == "--server")
+			{
+				options.server = argv[++i];
+			}
+			else if (arg == "--port")
+			{
+				options.port = static_cast<uint16_t>(std::clamp(std::atoi(argv[++i]), 1, 65535));
+			}
+			else if (arg == "--clients")
+			{
+				options.clients = std::clamp(std::atoi(argv[++i]), 1, 100000);
+			}
+			else if (arg == "--rate")
+			{
+				options.rate = std::clamp(std::atof(argv[++i]), 1.0, 1000.0);
+			}
+			else if (arg == "--duration")
+			{
+				options.duration = std::clamp(std::atof(argv[++i]), 1.0, 3600.0);
+			}
+			else if (arg == "--bullets")
+			{
+				options.bullets = std::clamp(std::atoi(argv[++i]), 0, 64);
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void SendHandshake(Client& client, clock_type::time_point now)
+	{
+		send(client.socket, HANDSHAKE_MESSAGE, sizeof(HANDSHAKE_MESSAGE) - 1, 0);
+		client.handshake_sent = now;
+	}
+
+	/*
+	* brief: one scripted SEND_PLAYERS; x steps one quantum per input so the
+	*        snapshot that carries it can be traced back
+	*/
+	void SendInput(Client& client, const Options& options, std::vector<char>& buffer, clock_type::time_point now)
+	{
+		uint32_t slot = client.input % LATENCY_WINDOW;
+
+		Player player{};
+		player.player_id = client.player_index;
+		player.position.x = WIRE_FORMAT.position_x.dequantize(LATENCY_BASE_X + slot);
+		player.position.y = static_cast<float>(client.player_index * 100 - 150);
+		player.direction = static_cast<float>(client.input % 628) / 100.0f - 3.14f;
+		player.num_bullets = options.bullets;
+
+		CMDID id = SEND_PLAYERS;
+		buffer.resize(sizeof(id) + sizeof(client.newest_sequence));
+		memcpy(buffer.data(), &id, sizeof(id));
+		memcpy(buffer.data() + sizeof(id), &client.newest_sequence, sizeof(client.newest_sequence));
+
+		BitWriter out(buffer);
+		WritePlayer(out, player);
+		out.write(static_cast<uint32_t>(options.bullets), WIRE_FORMAT.bullet_count_bits);
+		for (int i = 0; i < options.bullets; ++i)
+		{
+			Bullet bullet{ client.player_index, { player.position.x, static_cast<float>(i * 10) } };
+			WriteBullet(out, bullet);
+		}
+		out.flush();
+
+		send(client.socket, buffer.data(), static_cast<int>(buffer.size()), 0);
+		client.sent_at[slot] = now;
+		++client.input;
+		++client.counts.inputs;
+	}
+
+	/*
+	* brief: walk a SNAPSHOT_DELTA far enough to find this client's position,
+	*        if it changed, and record how long ago that input was sent.
+	*        Fields are self-describing, so no baseline is needed to skip them.
+	*/
+	void ReadSnapshot(Client& client, const char* data, size_t size, clock_type::time_point now, std::vector<uint32_t>& latency_us)
+	{
+		const size_t headerSize = sizeof(CMDID) + 2 * sizeof(uint32_t) + sizeof(uint8_t);
+		if (size < headerSize)
+		{
+			return;
+		}
+
+		uint32_t sequence;
+		uint8_t playerCount;
+		memcpy(&sequence, data + sizeof(CMDID), sizeof(sequence));
+		memcpy(&playerCount, data + sizeof(CMDID) + 2 * sizeof(uint32_t), sizeof(playerCount));
+
+		++client.counts.snapshots;
+		if (sequence <= client.newest_sequence)
+		{
+			++client.counts.stale;
+			return;
+		}
+		if (client.newest_sequence != 0)
+		{
+			client.counts.gaps += sequence - client.newest_sequence - 1;
+		}
+		client.newest_sequence = sequence;
+
+		BitReader in(data + headerSize, size - headerSize);
+		for (int i = 0; i < playerCount && in.ok(); ++i)
+		{
+			uint32_t mask = in.read(6);
+			if (mask & SF_PLAYER_ID)	in.read(WIRE_FORMAT.player_id_bits);
+			if (mask & SF_SHOOT)		in.read_bool();
+			Vec2 position{};
+			if (mask & SF_POSITION)		position = ReadPosition(in);
+
+			if (i == client.player_index)
+			{
+				if (mask & SF_POSITION)
+				{
+					uint32_t slot = WIRE_FORMAT.position_x.quantize(position.x) - LATENCY_BASE_X;
+					if (slot < LATENCY_WINDOW && client.sent_at[slot] != clock_type::time_point{})
+					{
+						auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - client.sent_at[slot]);
+						latency_us.push_back(static_cast<uint32_t>(latency.count()));
+						client.sent_at[slot] = clock_type::time_point{};
+					}
+				}
+				return;
+			}
+
+			if (mask & SF_VELOCITY)		ReadVelocity(in);
+			if (mask & SF_DIRECTION)	ReadAngle(in);
+			if (mask & SF_BULLETS)
+			{
+				uint32_t count = in.read(WIRE_FORMAT.bullet_count_bits);
+				std::vector<bool> changed(count);
+				for (uint32_t b = 0; b < count; ++b)
+				{
+					changed[b] = in.read_bool();
+				}
+				for (uint32_t b = 0; b < count; ++b)
+				{
+					if (changed[b])
+					{
+						Bullet bullet;
+						ReadBullet(in, bullet);
+					}
+				}
+			}
+		}
+	}
+
+	/*
+	* brief: handle one datagram according to where the client is in the handshake
+	*/
+	void Receive(Client& client, const char* data, size_t size, clock_type::time_point now, std::vector<uint32_t>& latency_us)
+	{
+		// The handshake reply and start signal are bare ASCII digits
+		if (client.state != State::PLAYING && size > 0 && size < sizeof(CMDID))
+		{
+			if (client.state == State::HANDSHAKE)
+			{
+				// Seats are 0..PLAYERS_PER_MATCH-1. Anything else is the start
+				// signal overtaking a lost seat reply; the next handshake retry
+				// is answered with the seat and the start signal again.
+				int seat = std::atoi(std::string(data, size).c_str());
+				if (seat < 0 || seat >= PLAYERS_PER_MATCH)
+				{
+					return;
+				}
+				client.player_index = seat;
+				client.state = State::SEATED;
+			}
+			else
+			{
+				client.state = State::PLAYING;
+				client.next_send = now;
+			}
+			return;
+		}
+
+		client.counts.bytes += size;
+		CMDID id = UNKNOWN;
+		if (size >= sizeof(id))
+		{
+			memcpy(&id, data, sizeof(id));
+		}
+		switch (id)
+		{
+		case SNAPSHOT_DELTA:
+			ReadSnapshot(client, data, size, now, latency_us);
+			break;
+		case RECEIVE_ASTEROIDS:
+			++client.counts.asteroids;
+			break;
+		case FRAGMENT:
+			++client.counts.fragments;
+			break;
+		default:
+			++client.counts.other;
+			break;
+		}
+	}
+
+	double Percentile(const std::vector<uint32_t>& sorted, double p)
+	{
+		if (sorted.empty())
+		{
+			return 0.0;
+		}
+		size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1));
+		return sorted[index] / 1000.0;
+	}
+
+	void Report(const Options& options, const std::vector<Client>& clients, std::vector<uint32_t>& latency_us, double seconds)
+	{
+		Counts total;
+		size_t playing = 0, handshaking = 0, seated = 0;
+		for (const Client& client : clients)
+		{
+			playing += client.state == State::PLAYING;
+			handshaking += client.state == State::HANDSHAKE;
+			seated += client.state == State::SEATED;
+			total.inputs += client.counts.inputs;
+			total.snapshots += client.counts.snapshots;
+			total.asteroids += client.counts.asteroids;
+			total.fragments += client.counts.fragments;
+			total.other += client.counts.other;
+			total.bytes += client.counts.bytes;
+			total.gaps += client.counts.gaps;
+			total.stale += client.counts.stale;
+		}
+		std::sort(latency_us.begin(), latency_us.end());
+
+		uint64_t received = total.snapshots + total.asteroids + total.fragments + total.other;
+		double perClient = playing ? 1.0 / (static_cast<double>(playing) * seconds) : 0.0;
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "Clients " << playing << "/" << clients.size() << " playing, "
+			<< seconds << "s measured, " << options.rate << "Hz input"
+			<< " (" << handshaking << " awaiting seat, " << seated << " awaiting start)\n";
+		std::cout << "Sent     inputs=" << total.inputs
+			<< " (" << static_cast<double>(total.inputs) * perClient << "/s per client)\n";
+		std::cout << "Received datagrams=" << received
+			<< " (" << static_cast<double>(received) * perClient << "/s per client)"
+			<< " snapshots=" << total.snapshots
+			<< " (" << static_cast<double>(total.snapshots) * perClient << "/s per client)"
+			<< " asteroids=" << total.asteroids
+			<< " fragments=" << total.fragments
+			<< " other=" << total.other
+			<< " bytes=" << total.bytes << "\n";
+		std::cout << "Latency  input to snapshot, " << latency_us.size() << " samples:"
+			<< " p50=" << Percentile(latency_us, 50.0) << "ms"
+			<< " p90=" << Percentile(latency_us, 90.0) << "ms"
+			<< " p99=" << Percentile(latency_us, 99.0) << "ms"
+			<< " max=" << Percentile(latency_us, 100.0) << "ms\n";
+		uint64_t expected = total.snapshots - total.stale + total.gaps;
+		std::cout << "Loss     snapshot sequence gaps=" << total.gaps
+			<< " (" << (expected ? 100.0 * static_cast<double>(total.gaps) / static_cast<double>(expected) : 0.0) << "%)"
+			<< " stale=" << total.stale << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		std::cerr << "Usage: loadgen [--server <ip>] [--port <port>] [--clients <n>]"
+			" [--rate <hz>] [--duration <seconds>] [--bullets <n>]\n";
+		return 1;
+	}
+	if (options.clients % PLAYERS_PER_MATCH != 0)
+	{
+		std::cerr << "warning: " << options.clients % PLAYERS_PER_MATCH
+			<< " clients will wait in a lobby that never fills\n";
+	}
+
+	if (!net_startup())
+	{
+		std::cerr << "WSAStartup() failed." << std::endl;
+		return 1;
+	}
+
+	sockaddr_in serverAddr{};
+	serverAddr.sin_family = AF_INET;
+	serverAddr.sin_port = htons(options.port);
+	if (inet_pton(AF_INET, options.server.c_str(), &serverAddr.sin_addr) != 1)
+	{
+		std::cerr << "bad server address " << options.server << '\n';
+		net_cleanup();
+		return 1;
+	}
+
+	EventLoop event_loop;
+	std::vector<Client> clients(static_cast<size_t>(options.clients));
+	std::unordered_map<SOCKET, size_t> bySocket;
+	clock_type::time_point now = clock_type::now();
+	for (size_t i = 0; i < clients.size(); ++i)
+	{
+		Client& client = clients[i];
+		client.socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		// A connected UDP socket only hears from the server, and send() needs no address
+		if (client.socket == INVALID_SOCKET ||
+			connect(client.socket, (SOCKADDR*)&serverAddr, sizeof(serverAddr)) != NO_ERROR ||
+			!set_nonblocking(client.socket, true) ||
+			!event_loop.add(client.socket))
+		{
+			std::cerr << "could not open client socket " << i << ": " << WSAGetLastError() << '\n';
+			net_cleanup();
+			return 1;
+		}
+		bySocket.emplace(client.socket, i);
+		SendHandshake(client, now);
+	}
+
+	const auto sendInterval = std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1.0 / options.rate));
+	std::vector<char> sendBuffer;
+	std::vector<char> receiveBuffer(RECEIVE_SIZE);
+	std::vector<uint32_t> latency_us;
+
+	clock_type::time_point startDeadline = clock_type::now() + START_TIMEOUT;
+	clock_type::time_point measureStart{};
+	clock_type::time_point measureEnd{};
+	bool measuring = false;
+
+	while (!measuring || now < measureEnd)
+	{
+		// Wake at least once a millisecond so inputs stay on schedule
+		int ready = event_loop.wait(1);
+		now = clock_type::now();
+		for (int r = 0; r < ready; ++r)
+		{
+			auto found = bySocket.find(event_loop.ready(r));
+			if (found == bySocket.end())
+			{
+				continue;
+			}
+			Client& client = clients[found->second];
+			while (true)
+			{
+				int bytesReceived = recv(client.socket, receiveBuffer.data(), static_cast<int>(receiveBuffer.size()), 0);
+				if (bytesReceived <= 0)
+				{
+					break;
+				}
+				Receive(client, receiveBuffer.data(), static_cast<size_t>(bytesReceived), now, latency_us);
+			}
+		}
+
+		size_t playing = 0;
+		for (Client& client : clients)
+		{
+			if (client.state == State::HANDSHAKE && now - client.handshake_sent >= HANDSHAKE_RETRY)
+			{
+				SendHandshake(client, now);
+			}
+			if (client.state != State::PLAYING)
+			{
+				continue;
+			}
+			++playing;
+			if (now >= client.next_send)
+			{
+				SendInput(client, options, sendBuffer, now);
+				// Stay on the schedule, but never try to make up for a stall
+				client.next_send = std::max(client.next_send + sendInterval, now);
+			}
+		}
+
+		if (!measuring && (playing == clients.size() - clients.size() % PLAYERS_PER_MATCH || now >= startDeadline))
+		{
+			// Warm-up traffic does not count
+			for (Client& client : clients)
+			{
+				client.counts = Counts{};
+			}
+			latency_us.clear();
+			measuring = true;
+			measureStart = now;
+			measureEnd = now + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(options.duration));
+			std::cout << playing << " clients playing; measuring for " << options.duration << "s" << std::endl;
+		}
+	}
+
+	Report(options, clients, latency_us, std::chrono::duration<double>(now - measureStart).count());
+
+	for (Client& client : clients)
+	{
+		event_loop.remove(client.socket);
+		closesocket(client.socket);
+	}
+	net_cleanup();
+	return 0;
+}
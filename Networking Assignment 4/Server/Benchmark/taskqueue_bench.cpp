@@ -0,0 +1,160 @@
+/******************************************************************************/
+/*!
+\file		taskqueue_bench.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Throughput and latency of TaskQueue (mutexes and condition
+			variables), LockFreeTaskQueue (MPMC ring) and WorkStealingQueue
+			(per-worker deques) at 1..32 producer and worker threads.
+
+			Usage: taskqueue_bench [tasks per run] [max threads]
+
+			Each run starts N workers and N producers. Every task carries the
+			time it was produced; the worker that runs it records the
+			produce-to-execute latency.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "lockfreetaskqueue.h"
+#include "taskqueue.h"
+#include "workstealingqueue.h"
+
+namespace
+{
+	using clock_type = std::chrono::steady_clock;
+
+	const size_t SLOT_COUNT = 1024;
+
+	struct Task
+	{
+		uint32_t index;
+		clock_type::time_point produced;
+	};
+
+	struct Result
+	{
+		double ops_per_sec;
+		double p50_us;
+		double p99_us;
+		double p999_us;
+	};
+
+	// Runs on the workers; every task index is written by exactly one worker.
+	struct RecordLatency
+	{
+		std::vector<uint32_t>& latency_ns;
+		std::atomic<size_t>& done;
+
+		bool operator()(const Task& task)
+		{
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - task.produced);
+			latency_ns[task.index] = static_cast<uint32_t>(std::min<int64_t>(elapsed.count(), UINT32_MAX));
+			done.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	};
+
+	struct NoDisconnect
+	{
+		void operator()() {}
+	};
+
+	double Percentile(const std::vector<uint32_t>& sorted, double p)
+	{
+		size_t index = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1));
+		return sorted[index] / 1000.0;
+	}
+
+	template <template <typename, typename, typename> class TQueue>
+	Result Run(size_t threads, size_t tasks)
+	{
+		std::vector<uint32_t> latency_ns(tasks);
+		std::atomic<size_t> done{ 0 };
+		RecordLatency action{ latency_ns, done };
+		NoDisconnect onDisconnect;
+
+		clock_type::time_point start;
+		clock_type::time_point end;
+		{
+			TQueue<Task, RecordLatency, NoDisconnect> queue(threads, SLOT_COUNT, action, onDisconnect);
+
+			start = clock_type::now();
+			std::vector<std::thread> producers;
+			for (size_t p = 0; p < threads; ++p)
+			{
+				producers.emplace_back([&, p]()
+					{
+						for (size_t i = p; i < tasks; i += threads)
+						{
+							queue.produce(Task{ static_cast<uint32_t>(i), clock_type::now() });
+						}
+					});
+			}
+			for (std::thread& producer : producers)
+			{
+				producer.join();
+			}
+			while (done.load(std::memory_order_relaxed) < tasks)
+			{
+				std::this_thread::yield();
+			}
+			end = clock_type::now();
+		}
+
+		std::sort(latency_ns.begin(), latency_ns.end());
+		double seconds = std::chrono::duration<double>(end - start).count();
+		return { tasks / seconds, Percentile(latency_ns, 50.0), Percentile(latency_ns, 99.0), Percentile(latency_ns, 99.9) };
+	}
+
+	void Print(const char* name, size_t threads, const Result& result)
+	{
+		std::cout << std::left << std::setw(10) << name
+			<< std::right << std::setw(8) << threads
+			<< std::setw(14) << static_cast<uint64_t>(result.ops_per_sec)
+			<< std::fixed << std::setprecision(1)
+			<< std::setw(12) << result.p50_us
+			<< std::setw(12) << result.p99_us
+			<< std::setw(12) << result.p999_us
+			<< std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	size_t tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	size_t max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+	tasks = std::max<size_t>(tasks, 1);
+
+	std::cout << "tasks per run: " << tasks << ", slots: " << SLOT_COUNT
+		<< ", hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+	std::cout << std::left << std::setw(10) << "queue"
+		<< std::right << std::setw(8) << "threads"
+		<< std::setw(14) << "ops/sec"
+		<< std::setw(12) << "p50 us"
+		<< std::setw(12) << "p99 us"
+		<< std::setw(12) << "p99.9 us"
+		<< std::endl;
+
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		Print("mutex", threads, Run<TaskQueue>(threads, tasks));
+		Print("lockfree", threads, Run<LockFreeTaskQueue>(threads, tasks));
+		Print("stealing", threads, Run<WorkStealingQueue>(threads, tasks));
+	}
+	return 0;
+}
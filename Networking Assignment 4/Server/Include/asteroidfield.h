@@ -0,0 +1,93 @@
+/******************************************************************************/
+/*!
+\file		asteroidfield.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		The server's authoritative asteroid state: a fixed-capacity
+			pool that never allocates after construction.
+
+			Asteroid data lives in dense structure-of-arrays form so the
+			per-tick integration walks plain float arrays the compiler can
+			vectorize, and encoders iterate 0..size() without skipping holes.
+			Removing an asteroid moves the last one into its place.
+
+			Each asteroid's id is its pool slot in the low 16 bits and that
+			slot's generation in the high 16. A slot's generation is bumped
+			when it is freed, so an id held after its asteroid is gone never
+			matches whatever reuses the slot. Free slots are kept on a stack,
+			making spawn and despawn O(1).
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "server.h"
+
+class AsteroidField
+{
+public:
+	// Returned by spawn() when the pool is full
+	static const uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+	// capacity is capped at 65536, the slots one id can address.
+	explicit AsteroidField(size_t capacity);
+
+	// Returns the new asteroid's id, or INVALID_ID when the pool is full.
+	uint32_t spawn(float size, Vec2 position, Vec2 velocity, float rotation);
+
+	// Returns false if id is stale or was never issued.
+	bool despawn(uint32_t id);
+	bool alive(uint32_t id) const;
+
+	// Moves every asteroid along its velocity by dt seconds and ages it.
+	void integrate(float dt);
+
+	// Removes every asteroid older than max_age seconds or whose centre lies
+	// outside the rectangle; returns how many were removed.
+	size_t expire(float max_age, float min_x, float max_x, float min_y, float max_y);
+
+	size_t size() const { return _count; }
+	size_t capacity() const { return _slot_dense.size(); }
+	bool empty() const { return _count == 0; }
+	bool full() const { return _free.empty(); }
+
+	// Gathers the asteroid at a dense index (0..size()) into the wire struct.
+	ASTEROID get(size_t index) const;
+
+	// Pool slot an id refers to, 0..capacity(); stable for the asteroid's life
+	static size_t slot(uint32_t id) { return id & SLOT_MASK; }
+
+private:
+	static const unsigned SLOT_BITS = 16;
+	static const uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+
+	void remove(size_t index);
+
+	size_t _count = 0;
+
+	// Dense, indexed 0.._count
+	std::vector<uint32_t> _id;
+	std::vector<float> _size;
+	std::vector<float> _pos_x;
+	std::vector<float> _pos_y;
+	std::vector<float> _vel_x;
+	std::vector<float> _vel_y;
+	std::vector<float> _rot;
+	std::vector<float> _age;
+
+	// Per slot
+	std::vector<uint16_t> _generation;
+	std::vector<uint32_t> _slot_dense;
+
+	// Stack of free slots
+	std::vector<uint32_t> _free;
+};
@@ -0,0 +1,122 @@
+/******************************************************************************/
+/*!
+\file		controlchannel.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		TCP control channel for admin commands (REQ_LISTUSERS,
+			REQ_QUIT). The listener and every connection sit in the
+			server's EventLoop, so a command is handled as soon as its
+			last byte arrives instead of on a polling timer.
+
+			Every message in both directions is one frame:
+
+				u32 length (network byte order), then length bytes of
+				u8 CMDID followed by the command's payload
+
+			Each connection reads into its own ReceiveRing and parses
+			every complete frame where it lies; a partial frame waits for
+			the rest of its bytes.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "netplatform.h"
+#include "rosterimage.h"
+#include "sessiontable.h"
+
+/*
+* Fixed-size receive buffer for one connection. Bytes are read in at the
+* write end and consumed from the read end; once everything is consumed
+* both ends rewind to the start, and a frame left straddling the end is
+* slid back to the front, so unread bytes are always contiguous.
+*/
+class ReceiveRing
+{
+public:
+	explicit ReceiveRing(size_t capacity) : _bytes(capacity) {}
+
+	// Unread bytes
+	const char* data() const { return _bytes.data() + _read; }
+	size_t size() const { return _write - _read; }
+	void consume(size_t count);
+
+	// Room for the next recv(); compacts first if the tail is full.
+	char* space();
+	size_t space_size() const { return _bytes.size() - _write; }
+	void commit(size_t count) { _write += count; }
+
+	size_t capacity() const { return _bytes.size(); }
+
+private:
+	std::vector<char> _bytes;
+	size_t _read = 0;
+	size_t _write = 0;
+};
+
+class ControlChannel
+{
+public:
+	// Largest frame body accepted; also the size of each connection's ring
+	static const size_t MAX_FRAME_SIZE = 4096;
+	static const size_t FRAME_HEADER_SIZE = sizeof(uint32_t);
+
+	explicit ControlChannel(EventLoop& event_loop);
+	~ControlChannel();
+
+	ControlChannel(const ControlChannel&) = delete;
+	ControlChannel& operator=(const ControlChannel&) = delete;
+
+	// Opens a non-blocking listener on port and registers it with the loop.
+	bool listen(uint16_t port);
+
+	// True if socket is the listener or one of the connections.
+	bool owns(SOCKET socket) const;
+
+	// Call for every ready socket owns() accepted.
+	void on_ready(SOCKET socket);
+
+	size_t connection_count() const { return _connections.size(); }
+
+	// The ready-made RSP_LISTUSERS reply; safe to read from any thread.
+	const RosterImage& roster() const { return _roster; }
+
+private:
+	struct Connection
+	{
+		EndpointKey key;
+		ReceiveRing ring{ FRAME_HEADER_SIZE + MAX_FRAME_SIZE };
+	};
+
+	void accept_all();
+	// Returns false once the connection should be closed.
+	bool read(SOCKET socket, Connection& connection);
+	bool handle_frame(SOCKET socket, const char* frame, size_t size);
+	void close(SOCKET socket);
+
+	bool send_all(SOCKET socket, const char* data, size_t size);
+	bool send_frame(SOCKET socket, const char* body, size_t size);
+	bool respond_list_user(SOCKET socket);
+	bool send_unknown(SOCKET socket);
+
+	EventLoop& _event_loop;
+	SOCKET _listener = INVALID_SOCKET;
+
+	std::unordered_map<SOCKET, std::unique_ptr<Connection>> _connections;
+	// Connected users, kept as the reply REQ_LISTUSERS sends
+	RosterImage _roster;
+
+	// Reused by every reply
+	std::vector<char> _send_buffer;
+};
@@ -0,0 +1,88 @@
+/******************************************************************************/
+/*!
+\file		fanout.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Snapshot fan-out stage. A payload is built once by the caller and
+			handed to every connected client in a single sendmmsg batch on
+			Linux, or one sendto per client elsewhere.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "netplatform.h"
+
+class Fanout
+{
+public:
+	explicit Fanout(SOCKET socket = INVALID_SOCKET);
+
+	void set_socket(SOCKET socket) { _socket = socket; }
+	SOCKET socket() const { return _socket; }
+
+	// Destination list; rebuilt whenever a client joins or leaves.
+	void clear_destinations();
+	void add_destination(const sockaddr_in& address);
+	size_t destination_count() const { return _destinations.size(); }
+
+	// Sends the same payload to every destination.
+	// Returns the number of datagrams the kernel accepted.
+	int send(const char* data, size_t size);
+
+	// Queues a payload for a single address. Everything queued goes out in one
+	// batch on flush(); data must stay valid until then.
+	void queue(const char* data, size_t size, const sockaddr_in& address);
+	int flush();
+
+	// Per-tick accounting; call begin_tick() at the top of each tick.
+	void begin_tick();
+	uint64_t tick_datagrams() const { return _tick_datagrams; }
+	uint64_t tick_syscalls() const { return _tick_syscalls; }
+	uint64_t tick_syscalls_saved() const { return _tick_datagrams > _tick_syscalls ? _tick_datagrams - _tick_syscalls : 0; }
+
+	uint64_t total_datagrams() const { return _total_datagrams; }
+	uint64_t total_syscalls() const { return _total_syscalls; }
+	uint64_t total_syscalls_saved() const { return _total_datagrams > _total_syscalls ? _total_datagrams - _total_syscalls : 0; }
+	// Datagrams the kernel refused for a reason other than a full buffer
+	uint64_t total_failed() const { return _total_failed; }
+
+private:
+	SOCKET _socket;
+	std::vector<sockaddr_in> _destinations;
+
+	struct Queued
+	{
+		const char* data;
+		size_t size;
+		sockaddr_in address;
+	};
+	std::vector<Queued> _queued;
+
+#ifdef __linux__
+	int submit(mmsghdr* messages, size_t message_count);
+
+	std::vector<mmsghdr> _messages;
+	iovec _payload{};
+
+	std::vector<mmsghdr> _queued_messages;
+	std::vector<iovec> _queued_payloads;
+#endif
+
+	void count(int syscalls, int datagrams, int failed = 0);
+
+	uint64_t _tick_datagrams = 0;
+	uint64_t _tick_syscalls = 0;
+	uint64_t _total_datagrams = 0;
+	uint64_t _total_syscalls = 0;
+	uint64_t _total_failed = 0;
+};
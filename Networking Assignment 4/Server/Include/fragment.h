@@ -0,0 +1,61 @@
+/******************************************************************************/
+/*!
+\file		fragment.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Splits a message too big for one datagram into FRAGMENT
+			datagrams that each fit under MAX_DATAGRAM_SIZE, so nothing the
+			server sends relies on IP fragmentation. The client puts them
+			back together in Asteroids/Include/FragmentReassembler.h.
+
+			FRAGMENT layout:
+				CMDID		FRAGMENT
+				uint8		the CMDID of the message that was split
+				uint32		message id, shared by every fragment of a message
+				uint8		fragment index
+				uint8		fragment count
+				bytes		up to FRAGMENT_PAYLOAD_SIZE bytes of the message
+
+			Each CMDID numbers its messages on its own and is reassembled on
+			its own, so a finished asteroid update never makes an unfinished
+			snapshot look stale, or the reverse.
+
+			The reassembled message is an ordinary datagram, CMDID first.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "server.h"
+
+// Largest datagram the server sends; leaves room for IP/UDP headers and a
+// tunnel or PPPoE header under a 1280-byte path MTU
+const size_t MAX_DATAGRAM_SIZE = 1200;
+
+const size_t FRAGMENT_HEADER_SIZE = sizeof(CMDID) + sizeof(uint8_t) + sizeof(uint32_t) + 2 * sizeof(uint8_t);
+const size_t FRAGMENT_PAYLOAD_SIZE = MAX_DATAGRAM_SIZE - FRAGMENT_HEADER_SIZE;
+
+// Fragments per message; the client sizes its reassembly buffers from this
+const size_t MAX_FRAGMENTS = 32;
+const size_t MAX_FRAGMENTED_SIZE = MAX_FRAGMENTS * FRAGMENT_PAYLOAD_SIZE;
+
+/*
+* brief: write the FRAGMENT datagrams for a message end to end into out;
+*        fragment i starts at i * MAX_DATAGRAM_SIZE and only the last may be
+*        shorter
+* param: data
+* param: size
+* param: message_id	next id in the sequence of the message's CMDID
+* param: out
+* return: number of fragments, or 0 if the message exceeds MAX_FRAGMENTED_SIZE
+*/
+size_t FragmentMessage(const char* data, size_t size, uint32_t message_id, std::vector<char>& out);
@@ -0,0 +1,77 @@
+/******************************************************************************/
+/*!
+\file		laghistory.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Lag-compensation history: where every entity was over the last
+			fraction of a second, so a hit a client claims can be checked
+			against the world as that client saw it rather than as it is by
+			the time the claim arrives.
+
+			One frame is recorded per tick. Samples are stored entity-major
+			(all frames of slot 0, then all frames of slot 1, ...), so
+			rewinding one entity reads two neighbouring samples from the
+			same cache line. An entity is identified by its slot plus an id
+			that must match, so a slot reused by a new entity never answers
+			for the one that left it.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "server.h"
+
+class LagHistory
+{
+public:
+	// Marks an entity as absent from a frame
+	static const uint32_t NO_ENTITY = 0xFFFFFFFFu;
+
+	// entity_slots: entities tracked at once
+	// frames:       frames kept; the window is frames ticks long
+	LagHistory(size_t entity_slots, size_t frames);
+
+	// Starts a new frame at time (seconds, strictly increasing), replacing the
+	// oldest. Every entity is absent from it until store()d.
+	void begin_frame(double time);
+	void store(size_t slot, uint32_t id, Vec2 position, float radius);
+
+	// Where the entity in slot with this id was at time, interpolated between
+	// the frames either side. A time past the newest frame gives the newest
+	// sample. Returns false if time is older than the window or the entity
+	// was absent from either frame.
+	bool rewind(size_t slot, uint32_t id, double time, Vec2& position, float& radius) const;
+
+	size_t recorded() const { return _recorded; }
+	double newest_time() const { return _times[_head]; }
+	double oldest_time() const { return _times[physical(0)]; }
+
+private:
+	struct Sample
+	{
+		uint32_t id;
+		float x;
+		float y;
+		float radius;
+	};
+
+	// Ring position of the i-th oldest recorded frame
+	size_t physical(size_t logical) const { return (_head + 1 + (_frames - _recorded) + logical) % _frames; }
+
+	size_t _slots;
+	size_t _frames;
+	size_t _head;
+	size_t _recorded = 0;
+	std::vector<double> _times;
+	// Indexed slot * _frames + frame
+	std::vector<Sample> _samples;
+};
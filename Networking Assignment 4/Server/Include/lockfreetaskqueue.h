@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * A producer-consumer pattern for the multi-threaded execution, backed by a
+ * bounded lock-free MPMC ring instead of mutexes and condition variables.
+ *
+ * Same contract as TaskQueue: produce() blocks while every slot is taken,
+ * consume() blocks until an item arrives and returns nullopt once the queue
+ * is disconnected and drained, and a worker whose action returns false
+ * disconnects the queue. Blocked threads spin for a short while and then
+ * park on an atomic wait, so an idle pool costs no CPU.
+ ******************************************************************************/
+
+#ifndef _LOCKFREETASKQUEUE_H_
+#define _LOCKFREETASKQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "mpmcring.h"
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+class LockFreeTaskQueue
+{
+public:
+	LockFreeTaskQueue(size_t workerCount, size_t slotCount, TAction& action, TOnDisconnect& disconnect);
+	~LockFreeTaskQueue();
+
+	std::optional<TItem> consume();
+	void produce(TItem item);
+
+	LockFreeTaskQueue() = delete;
+	LockFreeTaskQueue(const LockFreeTaskQueue&) = delete;
+	LockFreeTaskQueue(LockFreeTaskQueue&&) = delete;
+	LockFreeTaskQueue& operator=(const LockFreeTaskQueue&) = delete;
+	LockFreeTaskQueue& operator=(LockFreeTaskQueue&&) = delete;
+
+private:
+
+	static void work(LockFreeTaskQueue<TItem, TAction, TOnDisconnect>& tq, TAction& action);
+	void disconnect();
+
+	// Attempts before a blocked producer or consumer parks.
+	static constexpr int SPIN_COUNT = 256;
+	// SPIN_COUNT, or 0 on a single hardware thread where spinning only delays
+	// the thread we are waiting for.
+	const int _spinCount;
+
+	// Pool of worker threads.
+	std::vector<std::thread> _workers;
+
+	// Buffer of slots for items.
+	MPMCRing<TItem> _buffer;
+
+	// Bumped after every push / pop; parked consumers / producers wait on them.
+	std::atomic<uint32_t> _pushed{ 0 };
+	std::atomic<uint32_t> _popped{ 0 };
+
+	// Threads currently parked, so the hot path can skip the wake-up call.
+	std::atomic<int> _parkedConsumers{ 0 };
+	std::atomic<int> _parkedProducers{ 0 };
+
+	std::atomic<bool> _stay{ true };
+
+	TOnDisconnect& _onDisconnect;
+};
+
+#include "lockfreetaskqueue.hpp"
+
+#endif
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * A producer-consumer pattern for the multi-threaded execution, backed by a
+ * bounded lock-free MPMC ring instead of mutexes and condition variables.
+ ******************************************************************************/
+
+#ifndef _LOCKFREETASKQUEUE_HPP_
+#define _LOCKFREETASKQUEUE_HPP_
+#include <optional>
+#include "lockfreetaskqueue.h"
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::LockFreeTaskQueue(size_t workerCount, size_t slotCount, TAction& action, TOnDisconnect& onDisconnect) :
+	_spinCount{ std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0 },
+	_buffer{ slotCount },
+	_onDisconnect{ onDisconnect }
+{
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		_workers.emplace_back(&work, std::ref(*this), std::ref(action));
+	}
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::produce(TItem item)
+{
+	int spins = 0;
+	while (!_buffer.try_push(item))
+	{
+		// Spin briefly; a consumer usually frees a slot within a few hundred cycles.
+		if (spins < _spinCount)
+		{
+			++spins;
+			cpu_relax();
+			continue;
+		}
+
+		// Park until a consumer frees a slot. Registering before the last
+		// attempt means a pop after that attempt always changes _popped.
+		_parkedProducers.fetch_add(1);
+		uint32_t seen = _popped.load();
+		bool pushed = _buffer.try_push(item);
+		if (!pushed)
+		{
+			_popped.wait(seen);
+		}
+		_parkedProducers.fetch_sub(1);
+		if (pushed)
+		{
+			break;
+		}
+	}
+
+	// Announce available item.
+	_pushed.fetch_add(1);
+	if (_parkedConsumers.load() > 0)
+	{
+		_pushed.notify_one();
+	}
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+std::optional<TItem> LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::consume()
+{
+	int spins = 0;
+	std::optional<TItem> result = _buffer.try_pop();
+	while (!result)
+	{
+		// Termination once disconnected and drained.
+		if (!_stay.load())
+		{
+			return result;
+		}
+
+		if (spins < _spinCount)
+		{
+			++spins;
+			cpu_relax();
+		}
+		else
+		{
+			// Park until a producer pushes or the queue is disconnected.
+			_parkedConsumers.fetch_add(1);
+			uint32_t seen = _pushed.load();
+			result = _buffer.try_pop();
+			if (!result && _stay.load())
+			{
+				_pushed.wait(seen);
+			}
+			_parkedConsumers.fetch_sub(1);
+			if (result)
+			{
+				break;
+			}
+		}
+		result = _buffer.try_pop();
+	}
+
+	// Announce available slot.
+	_popped.fetch_add(1);
+	if (_parkedProducers.load() > 0)
+	{
+		_popped.notify_one();
+	}
+	return result;
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::work(LockFreeTaskQueue<TItem, TAction, TOnDisconnect>& tq, TAction& action)
+{
+	while (true)
+	{
+		std::optional<TItem> item = tq.consume();
+		if (!item)
+		{
+			// Termination of idle threads.
+			break;
+		}
+
+		if (!action(*item))
+		{
+			// Decision to terminate workers.
+			tq.disconnect();
+		}
+	}
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::disconnect()
+{
+	_stay = false;
+	// Wake every parked consumer so it can see _stay and exit.
+	_pushed.fetch_add(1);
+	_pushed.notify_all();
+	_onDisconnect();
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+LockFreeTaskQueue<TItem, TAction, TOnDisconnect>::~LockFreeTaskQueue()
+{
+	disconnect();
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+#endif
@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*!
+\file		match.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		One 4-player game. Owns everything that used to be global in
+			server.cpp (players, bullets, clients, asteroids and the
+			snapshot history) so a single process can host many matches.
+
+			A match is filled in the lobby by the I/O thread, then handed to
+			one MatchWorker and touched only by that worker's thread from then
+			on, so none of its state needs a lock.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asteroidfield.h"
+#include "fanout.h"
+#include "laghistory.h"
+#include "metrics.h"
+#include "netplatform.h"
+#include "server.h"
+#include "snapshot.h"
+#include "tokenbucket.h"
+
+const int MAX_PLAYERS = 4;
+
+// A tick's datagrams go out in this many evenly spaced bursts
+const int PACING_SLOTS = 4;
+
+// Default send budget per client, in bytes per second
+const uint32_t CLIENT_SEND_BUDGET = 16 * 1024;
+
+// Largest datagram we accept
+const size_t RECEIVE_BUFFER_SIZE = 4096;
+
+// How far back a hit claim can be rewound
+const double LAG_COMPENSATION_SECONDS = 0.5;
+
+class Match
+{
+public:
+	Match(uint32_t id, SOCKET socket, int tick_rate, uint32_t client_budget = CLIENT_SEND_BUDGET);
+	~Match();
+
+	Match(const Match&) = delete;
+	Match& operator=(const Match&) = delete;
+
+	uint32_t id() const { return _id; }
+
+	// Lobby, on the I/O thread before the match is handed to a worker.
+	// Seats the address and answers its handshake; returns its player_num.
+	uint16_t join(const sockaddr_in& address);
+	bool full() const { return _clients.size() >= MAX_PLAYERS; }
+	// Sends the start signal to every seated client.
+	void start();
+
+	// Worker thread only from here on.
+	// Applies one datagram from the client seated as player_num.
+	void receive(uint16_t player_num, const char* data, size_t size);
+	// Stops serving the seat after its session was dropped for going quiet.
+	void leave(uint16_t player_num);
+	// True once every seat has left; the worker then retires the match.
+	bool abandoned() const;
+	// Runs steps fixed simulation steps, then builds one snapshot and, every
+	// few ticks, the asteroid field. Sends pacing slot 0 before returning.
+	void tick(int steps, float dt);
+	// Sends what tick() left in a later pacing slot (1..PACING_SLOTS-1).
+	void send_paced(int slot);
+
+	// True if a bullet at position touches the asteroid as the world stood
+	// when player_num saw it: half that session's round trip ago, at most
+	// LAG_COMPENSATION_SECONDS.
+	bool evaluate_shot(uint16_t player_num, uint32_t asteroid_id, Vec2 position) const;
+
+	const Fanout& fanout() const { return _fanout; }
+	uint64_t snapshot_bytes_sent() const { return _snapshot_bytes_sent; }
+	uint64_t snapshot_bytes_raw() const { return _snapshot_bytes_raw; }
+	uint64_t sends_deferred() const { return _sends_deferred; }
+	uint64_t fragmented_messages() const { return _fragmented_messages; }
+	uint64_t fragments_built() const { return _fragments_built; }
+	uint64_t messages_oversized() const { return _messages_oversized; }
+	size_t asteroid_count() const { return _asteroids.size(); }
+
+	// Datagrams sent since the owner last published it
+	CommandTally& sent_tally() { return _sent_tally; }
+
+private:
+	// Per-client budget; parallel to _clients
+	struct Pacing
+	{
+		TokenBucket budget;
+		// Ticks between snapshots; doubles while the client is over budget
+		uint32_t snapshot_interval = 1;
+		uint32_t ticks_since_snapshot = 0;
+	};
+
+	// Per-client round trip and loss, exported as gauges; parallel to _clients
+	struct SessionStats
+	{
+		Gauge* rtt;
+		Gauge* loss;
+		// Both gauges' labels, to unregister them when the seat is left
+		std::string labels;
+		// Smoothed like TCP's SRTT; negative until the first sample
+		double smoothed_rtt = -1.0;
+		uint32_t window_sent = 0;
+		uint32_t window_acked = 0;
+	};
+
+	struct PacedSend
+	{
+		const char* data;
+		size_t size;
+		sockaddr_in address;
+	};
+
+	// Splits message into fragments if it does not fit one datagram; leaves
+	// fragments empty if it does. Returns false if it is too big to send.
+	// message_id is the sequence of the message's CMDID; it is advanced once
+	// per fragmented message.
+	bool fragment(const std::vector<char>& message, uint32_t& message_id, std::vector<char>& fragments);
+	// Charges the client's budget and queues the message, or its fragments
+	// if it has any, in the client's pacing slot.
+	bool pace(const ClientInfo& client, const std::vector<char>& message, const std::vector<char>& fragments);
+
+	// Called when a client's acknowledgement moves forward.
+	void on_ack(uint16_t player_num, uint32_t acked_sequence);
+
+	void simulate(float dt);
+	// Adds this tick's ship and asteroid positions to _history.
+	void record_history();
+	void send_snapshot();
+	void send_asteroids();
+	void spawn_asteroids(unsigned int count);
+	float rand_float();
+
+	uint32_t _id;
+
+	std::vector<ClientInfo> _clients;
+	std::vector<Pacing> _pacing;
+	std::vector<SessionStats> _session_stats;
+	uint32_t _client_budget;
+	std::vector<Player> _players;
+	std::vector<std::vector<Bullet>> _bullets;
+
+	// Authoritative; clients only render what send_asteroids() broadcasts
+	AsteroidField _asteroids;
+	float _asteroid_timer = 0.f;
+	// Simulated seconds since the match started; the clock _history runs on
+	double _time = 0.0;
+	// Ships in slots 0..MAX_PLAYERS, then asteroids by pool slot
+	LagHistory _history;
+	Counter* _hits_confirmed;
+	Counter* _hits_rejected;
+	uint32_t _ticks_since_asteroids = 0;
+	std::minstd_rand _random;
+
+	// Every broadcast builds its payload once and hands it to the fan-out stage
+	Fanout _fanout;
+	std::vector<std::vector<PacedSend>> _paced;
+
+	SnapshotHistory _snapshot_history;
+	uint32_t _snapshot_sequence = 0;
+	// When each snapshot in the history went out, for round-trip samples
+	std::vector<std::chrono::steady_clock::time_point> _snapshot_sent_at;
+	std::vector<std::vector<char>> _snapshot_buffers;
+	std::vector<std::vector<char>> _snapshot_fragments;
+	std::vector<char> _asteroid_buffer;
+	std::vector<char> _asteroid_fragments;
+	// FRAGMENT message ids, numbered per CMDID
+	uint32_t _snapshot_message_id = 0;
+	uint32_t _asteroid_message_id = 0;
+
+	// Bytes actually sent versus what the raw layout would have cost
+	uint64_t _snapshot_bytes_sent = 0;
+	uint64_t _snapshot_bytes_raw = 0;
+	// Snapshots and asteroid updates held back by a client's budget
+	uint64_t _sends_deferred = 0;
+	uint64_t _fragmented_messages = 0;
+	uint64_t _fragments_built = 0;
+	uint64_t _messages_oversized = 0;
+	CommandTally _sent_tally;
+	Histogram* _rtt_histogram;
+};
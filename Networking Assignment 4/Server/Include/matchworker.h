@@ -0,0 +1,135 @@
+/******************************************************************************/
+/*!
+\file		matchworker.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		A thread that owns a set of matches and ticks them on its own
+			TickScheduler. The I/O thread hands matches over with adopt() and
+			routes each client datagram to the owning worker with post();
+			both only touch the inbox, which the worker swaps out once per
+			tick. Match state itself is never shared between threads.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "match.h"
+#include "metrics.h"
+#include "tickscheduler.h"
+
+class MatchWorker
+{
+public:
+	MatchWorker(size_t index, int tick_rate, int max_catch_up);
+	~MatchWorker();
+
+	MatchWorker(const MatchWorker&) = delete;
+	MatchWorker& operator=(const MatchWorker&) = delete;
+
+	void start();
+	void stop();
+
+	// I/O thread. The worker owns the match from here on; the pointer stays
+	// valid for post() until every seat has been disconnected, after which
+	// the worker retires the match.
+	void adopt(std::unique_ptr<Match> match);
+
+	// I/O thread. Copies the datagram into the inbox; it is applied to the
+	// match at the start of the worker's next tick.
+	void post(Match* match, uint16_t player_num, const char* data, size_t size);
+
+	// I/O thread. The seat's session is gone; the match stops serving it
+	// after applying everything posted for it before this call.
+	void disconnect(Match* match, uint16_t player_num);
+
+	size_t index() const { return _index; }
+	size_t match_count() const { return _match_count.load(std::memory_order_relaxed); }
+	uint64_t dropped_datagrams() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct Inbox
+	{
+		struct Entry
+		{
+			Match* match;
+			uint16_t player_num;
+			size_t offset;
+			size_t size;
+		};
+
+		struct Departure
+		{
+			Match* match;
+			uint16_t player_num;
+		};
+
+		std::vector<char> bytes;
+		std::vector<Entry> entries;
+		std::vector<Departure> departures;
+		std::vector<std::unique_ptr<Match>> adopted;
+
+		void clear();
+	};
+
+	// Running totals for report(), summed over live and retired matches
+	struct MatchTotals
+	{
+		uint64_t datagrams = 0;
+		uint64_t syscalls = 0;
+		uint64_t saved = 0;
+		uint64_t failed = 0;
+		uint64_t sent = 0;
+		uint64_t raw = 0;
+		uint64_t deferred = 0;
+		uint64_t fragmented = 0;
+		uint64_t fragments = 0;
+		uint64_t oversized = 0;
+
+		void add(const Match& match);
+	};
+
+	void run();
+	// Drops matches every seat has left, keeping their totals.
+	void retire_abandoned();
+	void publish_metrics();
+	void report();
+
+	size_t _index;
+	TickScheduler _scheduler;
+
+	// Registered once; updated by the worker thread after every tick
+	Histogram* _tick_duration;
+	Gauge* _match_gauge;
+	Gauge* _asteroid_gauge;
+	CommandTraffic _sent_traffic;
+
+	// Worker thread only
+	std::vector<std::unique_ptr<Match>> _matches;
+	MatchTotals _retired;
+	Inbox _draining;
+
+	// Shared with the I/O thread under _inbox_mutex; swapped with _draining
+	std::mutex _inbox_mutex;
+	std::condition_variable _wake;
+	Inbox _incoming;
+	bool _stay = true;
+
+	std::atomic<size_t> _match_count{ 0 };
+	std::atomic<uint64_t> _dropped{ 0 };
+
+	std::thread _thread;
+};
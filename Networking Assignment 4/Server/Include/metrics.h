@@ -0,0 +1,172 @@
+/******************************************************************************/
+/*!
+\file		metrics.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		In-process metrics: counters, gauges and log-linear (HDR-style)
+			histograms, all updated with relaxed atomics so recording never
+			takes a lock or blocks the thread reading them.
+
+			Metrics are registered once by name and label set, usually when
+			the thing they describe is created, and the returned reference
+			stays valid for the life of the registry. write_prometheus()
+			renders everything in the Prometheus text exposition format.
+
+			Histograms keep 2^SUB_BUCKET_BITS buckets per power of two, so a
+			recorded value lands in a bucket at most 1/8 wider than itself
+			whatever its magnitude. Values are whole units (microseconds,
+			bytes...) and are scaled to the exported unit on output.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "server.h"
+
+// Counters touched by different threads each get their own cache line
+const size_t METRIC_ALIGNMENT = 64;
+
+struct alignas(METRIC_ALIGNMENT) Counter
+{
+	void add(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+	uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+	std::atomic<uint64_t> value{ 0 };
+};
+
+struct alignas(METRIC_ALIGNMENT) Gauge
+{
+	void set(double amount) { value.store(amount, std::memory_order_relaxed); }
+	double get() const { return value.load(std::memory_order_relaxed); }
+
+	std::atomic<double> value{ 0.0 };
+};
+
+class Histogram
+{
+public:
+	static const int SUB_BUCKET_BITS = 3;
+	static const uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+
+	// max_value: largest value told apart; anything above lands in the last bucket
+	// scale:     multiplier from recorded units to exported units
+	Histogram(uint64_t max_value, double scale);
+
+	void record(uint64_t value);
+
+	uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+	uint64_t sum() const { return _sum.load(std::memory_order_relaxed); }
+	double scale() const { return _scale; }
+
+	size_t bucket_count() const { return _bucket_count; }
+	uint64_t bucket(size_t index) const { return _buckets[index].load(std::memory_order_relaxed); }
+	// Largest value that falls in bucket index
+	static uint64_t bucket_upper(size_t index);
+	static size_t bucket_index(uint64_t value);
+
+private:
+	double _scale;
+	uint64_t _max_value;
+	size_t _bucket_count;
+	std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+	std::atomic<uint64_t> _count{ 0 };
+	std::atomic<uint64_t> _sum{ 0 };
+};
+
+class MetricsRegistry
+{
+public:
+	// labels is the inside of the braces, e.g. worker="0",cmd="SEND_PLAYERS".
+	// Registering the same name and labels again returns the same metric.
+	Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+	Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+	Histogram& histogram(const std::string& name, const std::string& help, const std::string& labels,
+		uint64_t max_value, double scale);
+
+	// Drops the series for name and labels. Any reference the caller still
+	// holds to it dangles from here on.
+	void remove(const std::string& name, const std::string& labels);
+
+	// A histogram only lists the buckets that have ever been hit, so each
+	// bucket series appears once and then stays for good.
+	void write_prometheus(std::ostream& os) const;
+
+	// Writes to a temporary file and renames it over path, so a collector
+	// never reads half a dump.
+	bool write_file(const std::string& path) const;
+
+private:
+	enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+	struct Series
+	{
+		std::string labels;
+		std::unique_ptr<Counter> counter;
+		std::unique_ptr<Gauge> gauge;
+		std::unique_ptr<Histogram> histogram;
+	};
+
+	struct Family
+	{
+		std::string name;
+		std::string help;
+		Type type;
+		std::vector<Series> series;
+	};
+
+	Series& find_or_add(const std::string& name, const std::string& help, Type type, const std::string& labels);
+
+	// Guards the family and series lists only; values are atomics
+	mutable std::mutex _mutex;
+	std::vector<std::unique_ptr<Family>> _families;
+};
+
+// The process-wide registry
+MetricsRegistry& Metrics();
+
+// Per-command datagram and byte counts, as plain integers so the thread that
+// sends or receives can count without atomics and publish once per batch.
+struct CommandTally
+{
+	// One slot per CMDID value that exists, plus HANDSHAKE and OTHER
+	static const size_t HANDSHAKE = ECHO_ERROR + 1;
+	static const size_t OTHER = ECHO_ERROR + 2;
+	static const size_t SLOTS = ECHO_ERROR + 3;
+
+	uint64_t datagrams[SLOTS] = {};
+	uint64_t bytes[SLOTS] = {};
+
+	// Files the datagram under the CMDID it starts with
+	void add(const char* data, size_t size);
+	// The text handshake and start messages, which carry no CMDID
+	void add_handshake(size_t size, uint64_t count = 1);
+};
+
+// server_datagrams_<direction>_total and server_bytes_<direction>_total by cmd
+class CommandTraffic
+{
+public:
+	// direction: "received" or "sent"
+	CommandTraffic(MetricsRegistry& registry, const std::string& direction);
+
+	// Adds the tally to the counters and zeroes it.
+	void publish(CommandTally& tally);
+
+private:
+	Counter* _datagrams[CommandTally::SLOTS] = {};
+	Counter* _bytes[CommandTally::SLOTS] = {};
+};
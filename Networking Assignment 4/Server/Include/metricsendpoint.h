@@ -0,0 +1,77 @@
+/******************************************************************************/
+/*!
+\file		metricsendpoint.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Minimal HTTP endpoint a Prometheus server can scrape. Listens on
+			the loopback interface only and sits in the server's EventLoop
+			next to the control channel: every request, whatever its path,
+			is answered with the registry in text format and the connection
+			is closed once the reply is written.
+
+			Sends never block, so a slow scraper can never stall the thread
+			that also receives game datagrams. Whatever the kernel does not
+			take at once is kept with the connection, which is then watched
+			for writability and topped up until the whole reply is out.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "metrics.h"
+#include "netplatform.h"
+
+class MetricsEndpoint
+{
+public:
+	// A request header larger than this is not a scrape; the connection is dropped.
+	static const size_t MAX_REQUEST_SIZE = 4096;
+
+	MetricsEndpoint(EventLoop& event_loop, const MetricsRegistry& registry);
+	~MetricsEndpoint();
+
+	MetricsEndpoint(const MetricsEndpoint&) = delete;
+	MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+	// Opens a non-blocking listener on 127.0.0.1:port and registers it with the loop.
+	bool listen(uint16_t port);
+
+	// True if socket is the listener or one of the connections.
+	bool owns(SOCKET socket) const;
+
+	// Call for every ready socket owns() accepted.
+	void on_ready(SOCKET socket);
+
+private:
+	struct Connection
+	{
+		// Request bytes read so far, until the blank line that ends the header
+		std::string request;
+		// The whole reply once the request is complete, and how much of it is out
+		std::string response;
+		size_t sent = 0;
+	};
+
+	void accept_all();
+	// These return false once the connection should be closed.
+	bool read(SOCKET socket, Connection& connection);
+	bool respond(SOCKET socket, Connection& connection);
+	bool flush(SOCKET socket, Connection& connection);
+	void close(SOCKET socket);
+
+	EventLoop& _event_loop;
+	const MetricsRegistry& _registry;
+	SOCKET _listener = INVALID_SOCKET;
+
+	std::unordered_map<SOCKET, Connection> _connections;
+};
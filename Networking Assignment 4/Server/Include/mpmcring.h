@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * A bounded lock-free multi-producer multi-consumer ring buffer
+ *
+ * Every cell carries a sequence number that tells producers and consumers
+ * whose turn it is, so a push or pop is one CAS on the shared position plus
+ * one release store on the cell. Capacity is rounded up to a power of two.
+ ******************************************************************************/
+
+#ifndef _MPMCRING_H_
+#define _MPMCRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+// Hint to the CPU that we are in a spin-wait loop.
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	_mm_pause();
+#endif
+}
+
+template <typename TItem>
+class MPMCRing
+{
+public:
+	explicit MPMCRing(size_t capacity);
+
+	// Returns false instead of blocking when the ring is full.
+	bool try_push(const TItem& item);
+	// Returns nullopt instead of blocking when the ring is empty.
+	std::optional<TItem> try_pop();
+
+	size_t capacity() const { return _mask + 1; }
+
+	MPMCRing(const MPMCRing&) = delete;
+	MPMCRing& operator=(const MPMCRing&) = delete;
+
+private:
+	// Keeps the producer and consumer positions off each other's cache line.
+	static constexpr size_t CACHE_LINE = 64;
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		std::optional<TItem> item;
+	};
+
+	std::unique_ptr<Cell[]> _cells;
+	size_t _mask;
+
+	alignas(CACHE_LINE) std::atomic<size_t> _enqueuePos{ 0 };
+	alignas(CACHE_LINE) std::atomic<size_t> _dequeuePos{ 0 };
+};
+
+template <typename TItem>
+MPMCRing<TItem>::MPMCRing(size_t capacity)
+{
+	size_t rounded = 2;
+	while (rounded < capacity)
+	{
+		rounded <<= 1;
+	}
+	_mask = rounded - 1;
+
+	_cells = std::make_unique<Cell[]>(rounded);
+	for (size_t i = 0; i < rounded; ++i)
+	{
+		_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename TItem>
+bool MPMCRing<TItem>::try_push(const TItem& item)
+{
+	size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell& cell = _cells[pos & _mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+		if (diff == 0)
+		{
+			// The cell is free for this lap; claim it.
+			if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				cell.item = item;
+				cell.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+		{
+			// A consumer has not emptied this cell from the previous lap.
+			return false;
+		}
+		else
+		{
+			pos = _enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template <typename TItem>
+std::optional<TItem> MPMCRing<TItem>::try_pop()
+{
+	size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+	while (true)
+	{
+		Cell& cell = _cells[pos & _mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+		if (diff == 0)
+		{
+			// The cell holds an item for this lap; claim it.
+			if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				std::optional<TItem> result = std::move(cell.item);
+				cell.item.reset();
+				cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+				return result;
+			}
+		}
+		else if (diff < 0)
+		{
+			// Nothing has been pushed into this cell yet.
+			return std::nullopt;
+		}
+		else
+		{
+			pos = _dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,128 @@
+/******************************************************************************/
+/*!
+\file		netplatform.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Portable socket layer for the server. Maps the WinSock names the
+			server is written against onto BSD sockets, and provides a
+			readiness loop (epoll on Linux, poll elsewhere) so the main
+			loop can sleep until a datagram arrives or a tick is due.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#pragma comment(lib, "ws2_32.lib")
+
+// Windows never raises SIGPIPE, so there is nothing to suppress
+#define MSG_NOSIGNAL		0
+
+#else
+
+#include <sys/socket.h>		// sockets
+#include <sys/types.h>
+#include <netinet/in.h>		// sockaddr_in
+#include <arpa/inet.h>		// inet_pton, inet_ntop
+#include <netdb.h>			// addrinfo, getnameinfo
+#include <unistd.h>			// close, gethostname
+#include <fcntl.h>			// non-blocking sockets
+#include <poll.h>
+#include <cerrno>
+
+// Porting from the windows code
+using SOCKET = int;
+using SOCKADDR = sockaddr;
+#define INVALID_SOCKET		(-1)
+#define SOCKET_ERROR		(-1)
+#define NO_ERROR			0
+#define SD_BOTH				SHUT_RDWR
+#define WSAEWOULDBLOCK		EWOULDBLOCK
+#define closesocket(fd)		close(fd)
+#define WSAGetLastError()	errno
+
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+/*
+* brief: initialise the socket library (WSAStartup on windows)
+*/
+bool net_startup();
+
+/*
+* brief: release the socket library (WSACleanup on windows)
+*/
+void net_cleanup();
+
+/*
+* brief: switch a socket between blocking and non-blocking mode
+* param: socket
+* param: enable
+*/
+bool set_nonblocking(SOCKET socket, bool enable);
+
+/*
+* brief: true if the error code means "try again later" on a non-blocking socket
+* param: error
+*/
+bool would_block(int error);
+
+/*
+* brief: stop the console from echoing typed input
+*/
+void disable_console_echo();
+
+/*
+* Readiness loop over a set of sockets. On Linux this is an epoll instance,
+* on other platforms it falls back to poll / WSAPoll.
+*/
+class EventLoop
+{
+public:
+	EventLoop();
+	~EventLoop();
+
+	EventLoop(const EventLoop&) = delete;
+	EventLoop& operator=(const EventLoop&) = delete;
+
+	bool add(SOCKET socket);
+	void remove(SOCKET socket);
+
+	// While enabled the socket is reported when it can be written instead of
+	// when it can be read; errors and hang-ups are reported either way.
+	bool watch_writes(SOCKET socket, bool enable);
+
+	// Blocks until a registered socket is ready or timeout_ms elapses.
+	// Returns the number of ready sockets, 0 on timeout and -1 on error.
+	int wait(int timeout_ms);
+
+	// The i-th socket reported ready by the last wait().
+	SOCKET ready(int i) const;
+
+private:
+#ifdef __linux__
+	int _epoll;
+	std::vector<epoll_event> _events;
+#else
+	std::vector<pollfd> _fds;
+	std::vector<SOCKET> _ready;
+#endif
+};
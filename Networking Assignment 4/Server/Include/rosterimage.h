@@ -0,0 +1,61 @@
+/******************************************************************************/
+/*!
+\file		rosterimage.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		The complete RSP_LISTUSERS reply, kept ready to send.
+
+			The owning thread patches a private copy in place as users join
+			and leave (a leave moves the last entry into the hole), then
+			publishes an immutable copy. Any thread can take the published
+			image with image() and send it as is; an image a reader holds
+			is never modified, so readers take no lock.
+
+			Layout is the framed control reply: u32 frame length, u8
+			RSP_LISTUSERS, u16 count, then 4-byte IPv4 address and 2-byte
+			port per user, all in network byte order. IPv6 users are not
+			listed; the reply has no room for them.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sessiontable.h"
+
+class RosterImage
+{
+public:
+	using Image = std::shared_ptr<const std::vector<char>>;
+
+	RosterImage();
+
+	// Owning thread only
+	void add(const EndpointKey& key);
+	void remove(const EndpointKey& key);
+
+	// Any thread
+	Image image() const { return _published.load(std::memory_order_acquire); }
+
+private:
+	static const size_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint16_t);
+	static const size_t ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint16_t);
+
+	void publish();
+
+	// Owning thread only: the working copy and where each user sits in it
+	std::vector<char> _wire;
+	SessionTable<size_t> _offsets;
+
+	std::atomic<Image> _published;
+};
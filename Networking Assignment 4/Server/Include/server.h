@@ -1,10 +1,16 @@
 #pragma once
+#include <cstdint>
+#include <string>
+
+#include "netplatform.h"
+
 struct Bullet;
 
 struct ClientInfo {
 	sockaddr_in address;
 	bool isConnected;
 	uint16_t player_num;
+	uint32_t acked_sequence = 0;	// newest snapshot the client confirmed
 };
 
 struct Vec2
@@ -31,6 +37,21 @@ struct Bullet
 	Vec2 position;
 };
 
+struct ASTEROID
+{
+	int		_id;
+	bool	_active;
+
+	float	_size;
+	Vec2	_pos;
+	Vec2	_vel;
+	float	_rot;
+
+	ASTEROID() = default;
+	ASTEROID(int id, bool active, float size, Vec2 pos, Vec2 vel, float rot)
+		: _id(id), _active(active), _size(size), _pos(pos), _vel(vel), _rot(rot) {}
+};
+
 enum CMDID {
 	UNKNOWN = static_cast<unsigned char>(0x0),
 	REQ_QUIT = static_cast<unsigned char>(0x1),
@@ -42,18 +63,12 @@ enum CMDID {
 	RECEIVE_ASTEROIDS = static_cast<unsigned char>(0x7),
 	SEND_BULLETS = static_cast<unsigned char>(0x8),
 	RECEIVE_BULLETS = static_cast<unsigned char>(0x9),
+	SNAPSHOT_DELTA = static_cast<unsigned char>(0xA),
+	FRAGMENT = static_cast<unsigned char>(0xB),
+	ASTEROID_HIT = static_cast<unsigned char>(0xC),
 
 	CMD_TEST = static_cast<unsigned char>(0x20),
 	ECHO_ERROR = static_cast<unsigned char>(0x30)
 };
 
-void get_client_IP_and_port(SOCKET socket, char ip[NI_MAXHOST], char port[NI_MAXSERV]);
-int respond_echo(SOCKET socket, std::string const& message, CMDID cmd_id);
-int respond_list_user(SOCKET socket);
-
-void send_unknown(SOCKET socket);
-int send_message(SOCKET socket, CMDID commandId, const std::string& message);
-void remove_client(SOCKET socket);
-CMDID receive_message(SOCKET socket, const std::string& message);
-bool handle_message(SOCKET socket);
 void disconnect(SOCKET& listenerSocket);
\ No newline at end of file
@@ -0,0 +1,287 @@
+/******************************************************************************/
+/*!
+\file		sessiontable.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Per-endpoint state keyed by the sender's address, looked up once
+			per datagram without formatting anything.
+
+			An IPv4 endpoint packs into 48 bits (address << 16 | port, both
+			in network byte order); IPv6 keeps the whole 128-bit address plus
+			the port. The table is open addressing with linear probing and
+			backward-shift deletion, so a removed entry leaves no tombstone
+			and its slot is reused by the next insert. Every entry remembers
+			when it was last seen so idle endpoints can be swept out.
+
+			Pointers returned by find() and insert() are invalidated by the
+			next insert() or erase().
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "netplatform.h"
+
+struct EndpointKey
+{
+	// IPV4_TAG for IPv4, otherwise the first half of the IPv6 address
+	uint64_t high = 0;
+	// IPv4: address << 16 | port. IPv6: the second half of the address
+	uint64_t low = 0;
+	// IPv6 only; an IPv4 port is already packed into low
+	uint16_t port = 0;
+
+	// A multicast prefix, which is never the source of a datagram
+	static const uint64_t IPV4_TAG = ~0ull;
+
+	bool is_ipv4() const { return high == IPV4_TAG; }
+	// Both in network byte order; only meaningful for IPv4 keys.
+	uint32_t ipv4_address() const { return static_cast<uint32_t>(low >> 16); }
+	uint16_t ipv4_port() const { return static_cast<uint16_t>(low); }
+
+	bool operator==(const EndpointKey& other) const
+	{
+		return high == other.high && low == other.low && port == other.port;
+	}
+};
+
+/*
+* brief: key for an IPv4 address and port, both in network byte order
+*/
+EndpointKey MakeEndpointKey(uint32_t address, uint16_t port);
+EndpointKey MakeEndpointKey(const sockaddr_in& address);
+EndpointKey MakeEndpointKey(const sockaddr_in6& address);
+// Either family; an unknown family gives an all-zero key.
+EndpointKey MakeEndpointKey(const sockaddr_storage& address);
+
+size_t HashEndpointKey(const EndpointKey& key);
+
+// "ip:port", for logging only
+std::string EndpointKeyString(const EndpointKey& key);
+
+template <typename TValue>
+class SessionTable
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// capacity is rounded up to a power of two; the table doubles once it is
+	// three quarters full.
+	explicit SessionTable(size_t capacity = 64);
+
+	TValue* find(const EndpointKey& key);
+	// find() that also marks the entry as seen at now.
+	TValue* touch(const EndpointKey& key, Clock::time_point now);
+
+	// Inserts or overwrites.
+	TValue* insert(const EndpointKey& key, const TValue& value, Clock::time_point now);
+	bool erase(const EndpointKey& key);
+
+	// Removes every entry last seen before cutoff for which filter(key, value)
+	// returns true; returns how many were removed.
+	template <typename TFilter>
+	size_t evict_idle(Clock::time_point cutoff, TFilter&& filter);
+
+	// Calls fn(key, value) for every entry, in no particular order.
+	template <typename TFn>
+	void for_each(TFn&& fn) const;
+
+	size_t size() const { return _count; }
+	size_t capacity() const { return _slots.size(); }
+
+private:
+	struct Slot
+	{
+		EndpointKey key;
+		TValue value{};
+		Clock::time_point last_seen{};
+		bool used = false;
+	};
+
+	size_t home(const EndpointKey& key) const { return HashEndpointKey(key) & _mask; }
+	size_t locate(const EndpointKey& key) const;
+	void remove_at(size_t index);
+	void grow();
+
+	std::vector<Slot> _slots;
+	size_t _mask;
+	size_t _count = 0;
+};
+
+template <typename TValue>
+SessionTable<TValue>::SessionTable(size_t capacity)
+{
+	size_t rounded = 8;
+	while (rounded < capacity)
+	{
+		rounded <<= 1;
+	}
+	_slots.resize(rounded);
+	_mask = rounded - 1;
+}
+
+/*
+* brief: index of the slot holding key, or capacity() if it is absent
+*/
+template <typename TValue>
+size_t SessionTable<TValue>::locate(const EndpointKey& key) const
+{
+	// The table is never full, so the probe always reaches an empty slot.
+	for (size_t index = home(key);; index = (index + 1) & _mask)
+	{
+		const Slot& slot = _slots[index];
+		if (!slot.used)
+		{
+			return _slots.size();
+		}
+		if (slot.key == key)
+		{
+			return index;
+		}
+	}
+}
+
+template <typename TValue>
+TValue* SessionTable<TValue>::find(const EndpointKey& key)
+{
+	size_t index = locate(key);
+	return index == _slots.size() ? nullptr : &_slots[index].value;
+}
+
+template <typename TValue>
+TValue* SessionTable<TValue>::touch(const EndpointKey& key, Clock::time_point now)
+{
+	size_t index = locate(key);
+	if (index == _slots.size())
+	{
+		return nullptr;
+	}
+	_slots[index].last_seen = now;
+	return &_slots[index].value;
+}
+
+template <typename TValue>
+TValue* SessionTable<TValue>::insert(const EndpointKey& key, const TValue& value, Clock::time_point now)
+{
+	if ((_count + 1) * 4 > _slots.size() * 3)
+	{
+		grow();
+	}
+
+	size_t index = home(key);
+	while (_slots[index].used && !(_slots[index].key == key))
+	{
+		index = (index + 1) & _mask;
+	}
+
+	Slot& slot = _slots[index];
+	if (!slot.used)
+	{
+		slot.used = true;
+		slot.key = key;
+		++_count;
+	}
+	slot.value = value;
+	slot.last_seen = now;
+	return &slot.value;
+}
+
+template <typename TValue>
+bool SessionTable<TValue>::erase(const EndpointKey& key)
+{
+	size_t index = locate(key);
+	if (index == _slots.size())
+	{
+		return false;
+	}
+	remove_at(index);
+	return true;
+}
+
+template <typename TValue>
+template <typename TFilter>
+size_t SessionTable<TValue>::evict_idle(Clock::time_point cutoff, TFilter&& filter)
+{
+	size_t removed = 0;
+	size_t index = 0;
+	while (index < _slots.size())
+	{
+		Slot& slot = _slots[index];
+		if (slot.used && slot.last_seen < cutoff && filter(slot.key, slot.value))
+		{
+			// remove_at may shift a later entry into this slot; look at it again.
+			remove_at(index);
+			++removed;
+			continue;
+		}
+		++index;
+	}
+	return removed;
+}
+
+template <typename TValue>
+template <typename TFn>
+void SessionTable<TValue>::for_each(TFn&& fn) const
+{
+	for (const Slot& slot : _slots)
+	{
+		if (slot.used)
+		{
+			fn(slot.key, slot.value);
+		}
+	}
+}
+
+/*
+* brief: empty a slot and pull back any entry whose probe ran through it, so
+*        lookups never need tombstones
+*/
+template <typename TValue>
+void SessionTable<TValue>::remove_at(size_t index)
+{
+	size_t hole = index;
+	for (size_t next = (hole + 1) & _mask; _slots[next].used; next = (next + 1) & _mask)
+	{
+		// An entry may fill the hole only if the hole lies on its probe path,
+		// i.e. between its home slot and where it sits now.
+		size_t wanted = home(_slots[next].key);
+		bool movable = hole <= next ? (wanted <= hole || wanted > next) : (wanted <= hole && wanted > next);
+		if (movable)
+		{
+			_slots[hole] = std::move(_slots[next]);
+			hole = next;
+		}
+	}
+	_slots[hole] = Slot{};
+	--_count;
+}
+
+template <typename TValue>
+void SessionTable<TValue>::grow()
+{
+	std::vector<Slot> old;
+	old.swap(_slots);
+	_slots.resize(old.size() * 2);
+	_mask = _slots.size() - 1;
+	_count = 0;
+
+	for (Slot& slot : old)
+	{
+		if (slot.used)
+		{
+			insert(slot.key, slot.value, slot.last_seen);
+		}
+	}
+}
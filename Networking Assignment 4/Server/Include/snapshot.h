@@ -0,0 +1,96 @@
+/******************************************************************************/
+/*!
+\file		snapshot.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Delta-compressed world snapshots. The server keeps a ring of the
+			snapshots it has sent and encodes each outgoing snapshot against
+			the newest one the client has acknowledged, so only Player fields
+			and bullets that changed go on the wire.
+
+			SNAPSHOT_DELTA layout (byte-aligned header, then a bit stream in
+			the quantized encoding from wireformat.h):
+				CMDID		command id
+				uint32		sequence of this snapshot
+				uint32		baseline sequence (0 = encoded against empty state)
+				uint8		player count
+				per player:
+					6 bits	field mask (SnapshotField)
+					u8		player_id			if SF_PLAYER_ID
+					1 bit	shoot				if SF_SHOOT
+					pos x/y	position			if SF_POSITION
+					vel x/y	velocity			if SF_VELOCITY
+					angle	direction			if SF_DIRECTION
+					if SF_BULLETS:
+						u10		bullet count (also the player's num_bullets)
+						bits	changed-bullet bitmap, one bit per bullet
+						Bullet	each bullet whose bit is set
+				zero bits up to the next byte
+
+			A field only counts as changed if its quantized value changed.
+
+			SEND_PLAYERS from a client carries the acknowledgement:
+				CMDID, uint32 newest snapshot sequence applied, then a bit
+				stream of Player, u10 bullet count, Bullet[]
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "server.h"
+
+enum SnapshotField : uint8_t
+{
+	SF_PLAYER_ID = 0x01,
+	SF_SHOOT = 0x02,
+	SF_POSITION = 0x04,
+	SF_VELOCITY = 0x08,
+	SF_DIRECTION = 0x10,
+	SF_BULLETS = 0x20
+};
+
+struct WorldSnapshot
+{
+	uint32_t sequence = 0;
+	std::vector<Player> players;
+	std::vector<std::vector<Bullet>> bullets;
+};
+
+/*
+* Fixed ring of the snapshots most recently sent. Slots and their bullet
+* vectors are allocated once and reused as the ring wraps.
+*/
+class SnapshotHistory
+{
+public:
+	SnapshotHistory(size_t capacity, size_t player_count, size_t max_bullets);
+
+	// Claims the slot for a new sequence, evicting the oldest snapshot.
+	WorldSnapshot& push(uint32_t sequence);
+
+	// The snapshot sent with this sequence, or nullptr if it has been evicted.
+	const WorldSnapshot* find(uint32_t sequence) const;
+
+private:
+	std::vector<WorldSnapshot> _ring;
+};
+
+/*
+* brief: encode current against baseline (nullptr = empty state) into out
+* return: encoded size in bytes
+*/
+size_t EncodeSnapshotDelta(const WorldSnapshot& current, const WorldSnapshot* baseline, std::vector<char>& out);
+
+/*
+* brief: size the same snapshot would take in the old raw layout
+*/
+size_t RawSnapshotSize(const WorldSnapshot& snapshot);
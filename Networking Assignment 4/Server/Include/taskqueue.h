@@ -8,9 +8,12 @@
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <condition_variable>
 #include <optional>
 #include <thread>
 
+#include "taskqueuecounters.h"
+
 template <typename TItem, typename TAction, typename TOnDisconnect>
 class TaskQueue
 {
@@ -21,6 +24,10 @@ public:
 	std::optional<TItem> consume();
 	void produce(TItem item);
 
+	// Diagnostics are off unless asked for; see taskqueuecounters.h.
+	void enable_counters(bool enabled = true) { _countersEnabled = enabled; }
+	const TaskQueueCounters& counters() const { return _counters; }
+
 	TaskQueue() = delete;
 	TaskQueue(const TaskQueue&) = delete;
 	TaskQueue(TaskQueue&&) = delete;
@@ -53,6 +60,9 @@ private:
 
 	volatile bool _stay;
 
+	std::atomic<bool> _countersEnabled{ false };
+	TaskQueueCounters _counters;
+
 	TOnDisconnect& _onDisconnect;
 };
 
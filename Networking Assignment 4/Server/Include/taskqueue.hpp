@@ -6,14 +6,12 @@
 #define _TASKQUEUE_HPP_
 #include <optional>
 #include "taskqueue.h"
- //use for synch on stdout
-static std::mutex _stdoutMutex;
 template <typename TItem, typename TAction, typename TOnDisconnect>
 TaskQueue<TItem, TAction, TOnDisconnect>::TaskQueue(size_t workerCount, size_t slotCount, TAction& action, TOnDisconnect& onDisconnect) :
 	_slotCount{ slotCount },
 	_itemCount{ 0 },
-	_onDisconnect{ onDisconnect },
-	_stay{ true }
+	_stay{ true },
+	_onDisconnect{ onDisconnect }
 {
 	for (size_t i = 0; i < workerCount; ++i)
 	{
@@ -44,6 +42,11 @@ void TaskQueue<TItem, TAction, TOnDisconnect>::produce(TItem item)
 		++_itemCount;
 		_consumers.notify_one();
 	}
+
+	if (_countersEnabled.load(std::memory_order_relaxed))
+	{
+		TaskQueueCounters::add(_counters.produced);
+	}
 }
 
 template <typename TItem, typename TAction, typename TOnDisconnect>
@@ -54,6 +57,10 @@ std::optional<TItem> TaskQueue<TItem, TAction, TOnDisconnect>::consume()
 	{
 		// Wait for an available item or termination...
 		std::unique_lock<std::mutex> itemCountLock{ _itemCountMutex };
+		if (_itemCount == 0 && _stay && _countersEnabled.load(std::memory_order_relaxed))
+		{
+			TaskQueueCounters::add(_counters.parked);
+		}
 		_consumers.wait(itemCountLock, [&]() { return (_itemCount > 0) || (!_stay); });
 		if (_itemCount == 0)
 		{
@@ -84,14 +91,6 @@ void TaskQueue<TItem, TAction, TOnDisconnect>::work(TaskQueue<TItem, TAction, TO
 {
 	while (true)
 	{
-		{
-			std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
-			std::cout
-				<< "Thread ["
-				<< std::this_thread::get_id()
-				<< "] is waiting for a task."
-				<< std::endl;
-		}
 		std::optional<TItem> item = tq.consume();
 		if (!item)
 		{
@@ -99,36 +98,29 @@ void TaskQueue<TItem, TAction, TOnDisconnect>::work(TaskQueue<TItem, TAction, TO
 			break;
 		}
 
-		{
-			std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
-			std::cout
-				<< "Thread ["
-				<< std::this_thread::get_id()
-				<< "] is executing a task."
-				<< std::endl;
-		}
-
 		if (!action(*item))
 		{
 			// Decision to terminate workers.
 			tq.disconnect();
 		}
-	}
 
-	{
-		std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
-		std::cout
-			<< "Thread ["
-			<< std::this_thread::get_id()
-			<< "] is exiting."
-			<< std::endl;
+		if (tq._countersEnabled.load(std::memory_order_relaxed))
+		{
+			TaskQueueCounters::add(tq._counters.executed);
+		}
 	}
 }
 
 template <typename TItem, typename TAction, typename TOnDisconnect>
 void TaskQueue<TItem, TAction, TOnDisconnect>::disconnect()
 {
-	_stay = false;
+	// Set under the lock and wake every consumer; otherwise a worker idle in
+	// consume() never sees _stay change and the destructor's join() hangs.
+	{
+		std::lock_guard<std::mutex> itemCountLock(_itemCountMutex);
+		_stay = false;
+	}
+	_consumers.notify_all();
 	_onDisconnect();
 }
 
@@ -0,0 +1,28 @@
+/*******************************************************************************
+ * Opt-in diagnostics for the task queues
+ *
+ * Counting is off by default so the hot path stays silent; call
+ * enable_counters() on a queue and read counters() whenever you like.
+ * Every counter is a relaxed atomic, so reading one never blocks a worker.
+ ******************************************************************************/
+
+#ifndef _TASKQUEUECOUNTERS_H_
+#define _TASKQUEUECOUNTERS_H_
+
+#include <atomic>
+#include <cstdint>
+
+struct TaskQueueCounters
+{
+	std::atomic<uint64_t> produced{ 0 };	// items handed to produce()
+	std::atomic<uint64_t> executed{ 0 };	// actions run by the workers
+	std::atomic<uint64_t> stolen{ 0 };		// items a worker took from another worker's deque
+	std::atomic<uint64_t> parked{ 0 };		// times a worker found no work and went to sleep
+
+	static void add(std::atomic<uint64_t>& counter)
+	{
+		counter.fetch_add(1, std::memory_order_relaxed);
+	}
+};
+
+#endif
@@ -0,0 +1,79 @@
+/******************************************************************************/
+/*!
+\file		tickscheduler.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Fixed-rate tick scheduler for the server loop. Hands out tick
+			deadlines for the event loop to sleep on, applies a bounded
+			catch-up policy when a tick overruns, and keeps overrun counters
+			and tick-duration percentiles.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+class TickScheduler
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	// tick_rate:      ticks per second (20, 30, 60, ...)
+	// max_catch_up:   most simulation steps run back-to-back after an overrun;
+	//                 anything beyond that is dropped and counted
+	TickScheduler(int tick_rate, int max_catch_up = 3);
+
+	// Milliseconds until the next deadline, 0 if it is already due.
+	int timeout_ms() const;
+
+	// Number of simulation steps due now (0 if the deadline has not passed).
+	// Starts timing the tick when non-zero; pair with end().
+	int begin();
+
+	// Stops timing the current tick and records its duration.
+	void end();
+
+	float tick_seconds() const { return _tick_seconds; }
+	clock::duration interval() const { return _interval; }
+	int tick_rate() const { return _tick_rate; }
+
+	uint64_t ticks() const { return _ticks; }
+	uint64_t overruns() const { return _overruns; }
+	uint64_t late_ticks() const { return _late_ticks; }
+	uint64_t dropped_ticks() const { return _dropped_ticks; }
+
+	// Tick duration percentile (0..100) over the recent window, in microseconds.
+	uint32_t percentile_us(double p) const;
+
+	// Writes one summary line if report_interval has elapsed since the last one.
+	// Returns true if a line was written.
+	bool report(std::ostream& os, std::chrono::seconds report_interval = std::chrono::seconds(10));
+
+private:
+	int _tick_rate;
+	int _max_catch_up;
+	float _tick_seconds;
+	clock::duration _interval;
+	clock::time_point _next_tick;
+	clock::time_point _tick_start;
+	clock::time_point _last_report;
+
+	uint64_t _ticks = 0;
+	uint64_t _overruns = 0;			// ticks whose work took longer than one interval
+	uint64_t _late_ticks = 0;		// wake-ups that found more than one step due
+	uint64_t _dropped_ticks = 0;	// steps skipped once max_catch_up was reached
+
+	// Ring of recent tick durations in microseconds
+	std::vector<uint32_t> _samples;
+	size_t _sample_count = 0;
+	mutable std::vector<uint32_t> _scratch;
+};
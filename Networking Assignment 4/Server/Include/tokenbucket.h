@@ -0,0 +1,57 @@
+/******************************************************************************/
+/*!
+\file		tokenbucket.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Byte budget for one link. Tokens accrue at rate bytes per second
+			up to burst; a send spends as many tokens as it has bytes. A
+			send larger than burst is let through from a full bucket and
+			leaves it in debt, so it is paid for before anything else goes.
+			The bucket is refilled by simulated time, so it advances with
+			the ticks that produced the traffic.
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+class TokenBucket
+{
+public:
+	TokenBucket(float rate, float burst) :
+		_rate{ rate },
+		_burst{ burst },
+		_tokens{ burst }
+	{
+	}
+
+	void refill(float seconds) { _tokens = std::min(_burst, _tokens + _rate * seconds); }
+
+	// Spends size tokens if there are enough; otherwise leaves the bucket alone.
+	bool try_consume(size_t size)
+	{
+		float cost = static_cast<float>(size);
+		if (cost > _tokens && _tokens < _burst)
+		{
+			return false;
+		}
+		_tokens -= cost;
+		return true;
+	}
+
+	float tokens() const { return _tokens; }
+	float rate() const { return _rate; }
+	float burst() const { return _burst; }
+
+private:
+	float _rate;
+	float _burst;
+	float _tokens;
+};
@@ -0,0 +1,150 @@
+/******************************************************************************/
+/*!
+\file		wireformat.h
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Quantized, bit-packed wire encoding for Player, Bullet and
+			ASTEROID. Floats are mapped onto a fixed range and written with
+			only as many bits as the field needs; bools take one bit and
+			nothing is padded to struct alignment.
+
+			Per-field precision lives in WireFormat. The client keeps a copy
+			of the same defaults in Asteroids/Include/WireFormat.h; change
+			both together or the two ends will disagree on the layout.
+
+			Player (72 bits):	player_id u8, shoot u1, position x/y,
+								velocity x/y, direction
+			Bullet (36 bits):	player_id u8, position x/y
+			ASTEROID (104 bits):id u32, active u1, size, position x/y,
+								velocity x/y, rotation
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "server.h"
+
+/*
+* Appends values of 1..32 bits to a byte buffer, least significant bit first.
+*/
+class BitWriter
+{
+public:
+	explicit BitWriter(std::vector<char>& out) : _out(out) {}
+
+	void write(uint32_t value, unsigned bits);
+	void write_bool(bool value) { write(value ? 1u : 0u, 1); }
+
+	// Pads the last partial byte with zeros; call once after the last field.
+	void flush();
+
+	size_t bit_count() const { return _bits; }
+
+private:
+	std::vector<char>& _out;
+	uint64_t _acc = 0;
+	unsigned _pending = 0;
+	size_t _bits = 0;
+};
+
+/*
+* Reads what BitWriter wrote. A read past the end returns 0 and clears ok().
+*/
+class BitReader
+{
+public:
+	BitReader(const char* data, size_t size);
+
+	uint32_t read(unsigned bits);
+	bool read_bool() { return read(1) != 0; }
+
+	bool ok() const { return _ok; }
+
+private:
+	const uint8_t* _ptr;
+	const uint8_t* _end;
+	uint64_t _acc = 0;
+	unsigned _pending = 0;
+	bool _ok = true;
+};
+
+/*
+* A float mapped onto [min, max] in 2^bits - 1 even steps. Values outside the
+* range are clamped, so the range must cover everything the game can produce.
+*/
+struct QuantizedField
+{
+	float min;
+	float max;
+	unsigned bits;
+
+	uint32_t quantize(float value) const;
+	float dequantize(uint32_t q) const;
+
+	// Largest error quantize/dequantize can introduce inside the range.
+	float step() const { return (max - min) / static_cast<float>((1ull << bits) - 1); }
+};
+
+struct WireFormat
+{
+	// Sized to the 800x600 window plus the off-screen band asteroids spawn in
+	QuantizedField position_x{ -640.f, 640.f, 14 };
+	QuantizedField position_y{ -540.f, 540.f, 14 };
+	QuantizedField velocity{ -512.f, 512.f, 12 };
+	// Angles are wrapped to [-pi, pi] before quantizing
+	QuantizedField angle{ -3.14159265f, 3.14159265f, 11 };
+	QuantizedField size{ 0.f, 256.f, 8 };
+
+	unsigned player_id_bits = 8;
+	unsigned asteroid_id_bits = 32;
+	unsigned bullet_count_bits = 10;
+};
+
+// Layout every encoder and decoder on the server uses
+extern const WireFormat WIRE_FORMAT;
+
+/*
+* brief: quantize a value the way it will arrive on the other end
+*/
+uint32_t QuantizePosX(float value, const WireFormat& format = WIRE_FORMAT);
+uint32_t QuantizePosY(float value, const WireFormat& format = WIRE_FORMAT);
+uint32_t QuantizeVelocity(float value, const WireFormat& format = WIRE_FORMAT);
+uint32_t QuantizeAngle(float radians, const WireFormat& format = WIRE_FORMAT);
+
+void WritePosition(BitWriter& out, const Vec2& position, const WireFormat& format = WIRE_FORMAT);
+void WriteVelocity(BitWriter& out, const Vec2& velocity, const WireFormat& format = WIRE_FORMAT);
+void WriteAngle(BitWriter& out, float radians, const WireFormat& format = WIRE_FORMAT);
+Vec2 ReadPosition(BitReader& in, const WireFormat& format = WIRE_FORMAT);
+Vec2 ReadVelocity(BitReader& in, const WireFormat& format = WIRE_FORMAT);
+float ReadAngle(BitReader& in, const WireFormat& format = WIRE_FORMAT);
+
+// Whole entities. num_bullets is not part of Player on the wire; senders put
+// the bullet count in front of the bullets instead.
+void WritePlayer(BitWriter& out, const Player& player, const WireFormat& format = WIRE_FORMAT);
+void WriteBullet(BitWriter& out, const Bullet& bullet, const WireFormat& format = WIRE_FORMAT);
+void WriteAsteroid(BitWriter& out, const ASTEROID& asteroid, const WireFormat& format = WIRE_FORMAT);
+void ReadPlayer(BitReader& in, Player& player, const WireFormat& format = WIRE_FORMAT);
+void ReadBullet(BitReader& in, Bullet& bullet, const WireFormat& format = WIRE_FORMAT);
+void ReadAsteroid(BitReader& in, ASTEROID& asteroid, const WireFormat& format = WIRE_FORMAT);
+
+// Encoded size of each entity in bits
+size_t PlayerBits(const WireFormat& format = WIRE_FORMAT);
+size_t BulletBits(const WireFormat& format = WIRE_FORMAT);
+size_t AsteroidBits(const WireFormat& format = WIRE_FORMAT);
+
+/*
+* brief: round-trip sample entities through the format and print the bytes per
+*        entity against the raw struct size and the worst error per field
+* return: false if any field came back outside its quantization step
+*/
+bool WireReport(std::ostream& out, const WireFormat& format = WIRE_FORMAT);
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * A producer-consumer pattern for the multi-threaded execution, with one
+ * deque per worker and work stealing between them.
+ *
+ * Same construction and produce() contract as TaskQueue. An item produced
+ * from inside a worker's action goes onto that worker's own deque, so
+ * follow-up work stays on the core that has its data warm; items from any
+ * other thread are spread round-robin. A worker takes its newest item first
+ * and, when its deque is empty, steals the oldest item from the others.
+ * Idle workers spin briefly and then park.
+ ******************************************************************************/
+
+#ifndef _WORKSTEALINGQUEUE_H_
+#define _WORKSTEALINGQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "mpmcring.h"
+#include "taskqueuecounters.h"
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+class WorkStealingQueue
+{
+public:
+	// slotCount bounds the items queued across all workers.
+	WorkStealingQueue(size_t workerCount, size_t slotCount, TAction& action, TOnDisconnect& disconnect);
+	~WorkStealingQueue();
+
+	void produce(TItem item);
+
+	// Diagnostics are off unless asked for; see taskqueuecounters.h.
+	void enable_counters(bool enabled = true) { _countersEnabled = enabled; }
+	const TaskQueueCounters& counters() const { return _counters; }
+
+	WorkStealingQueue() = delete;
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue(WorkStealingQueue&&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(WorkStealingQueue&&) = delete;
+
+private:
+	// One per worker, on its own cache line. The owner works the back; thieves
+	// take from the front, so the lock is only contended while stealing.
+	struct alignas(64) Local
+	{
+		std::mutex mutex;
+		std::deque<TItem> items;
+	};
+
+	static void work(WorkStealingQueue<TItem, TAction, TOnDisconnect>& tq, TAction& action, size_t index);
+	std::optional<TItem> consume(size_t index);
+	std::optional<TItem> take(size_t index);
+	bool try_push(size_t index, TItem& item);
+	void disconnect();
+	void count(std::atomic<uint64_t>& counter);
+
+	// Attempts before a blocked producer or idle worker parks.
+	static constexpr int SPIN_COUNT = 256;
+	// SPIN_COUNT, or 0 on a single hardware thread where spinning only delays
+	// the thread we are waiting for.
+	const int _spinCount;
+
+	// Which queue and worker the calling thread is, if it is one of ours.
+	static thread_local const void* t_owner;
+	static thread_local size_t t_index;
+
+	std::vector<std::unique_ptr<Local>> _locals;
+	std::vector<std::thread> _workers;
+
+	// Items queued across every deque, against the slotCount bound.
+	std::atomic<size_t> _queued{ 0 };
+	size_t _slotCount;
+	std::atomic<size_t> _nextWorker{ 0 };
+
+	// Bumped after every push / pop; parked workers / producers wait on them.
+	std::atomic<uint32_t> _pushed{ 0 };
+	std::atomic<uint32_t> _popped{ 0 };
+	std::atomic<int> _parkedConsumers{ 0 };
+	std::atomic<int> _parkedProducers{ 0 };
+
+	std::atomic<bool> _stay{ true };
+
+	std::atomic<bool> _countersEnabled{ false };
+	TaskQueueCounters _counters;
+
+	TOnDisconnect& _onDisconnect;
+};
+
+#include "workstealingqueue.hpp"
+
+#endif
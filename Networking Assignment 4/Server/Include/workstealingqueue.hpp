@@ -0,0 +1,235 @@
+/*******************************************************************************
+ * A producer-consumer pattern for the multi-threaded execution, with one
+ * deque per worker and work stealing between them.
+ ******************************************************************************/
+
+#ifndef _WORKSTEALINGQUEUE_HPP_
+#define _WORKSTEALINGQUEUE_HPP_
+#include <optional>
+#include "workstealingqueue.h"
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+thread_local const void* WorkStealingQueue<TItem, TAction, TOnDisconnect>::t_owner = nullptr;
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+thread_local size_t WorkStealingQueue<TItem, TAction, TOnDisconnect>::t_index = 0;
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+WorkStealingQueue<TItem, TAction, TOnDisconnect>::WorkStealingQueue(size_t workerCount, size_t slotCount, TAction& action, TOnDisconnect& onDisconnect) :
+	_spinCount{ std::thread::hardware_concurrency() > 1 ? SPIN_COUNT : 0 },
+	_slotCount{ slotCount },
+	_onDisconnect{ onDisconnect }
+{
+	if (workerCount == 0)
+	{
+		workerCount = 1;
+	}
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		_locals.push_back(std::make_unique<Local>());
+	}
+	// Every deque exists before any worker can try to steal from it.
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		_workers.emplace_back(&work, std::ref(*this), std::ref(action), i);
+	}
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void WorkStealingQueue<TItem, TAction, TOnDisconnect>::count(std::atomic<uint64_t>& counter)
+{
+	if (_countersEnabled.load(std::memory_order_relaxed))
+	{
+		TaskQueueCounters::add(counter);
+	}
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+bool WorkStealingQueue<TItem, TAction, TOnDisconnect>::try_push(size_t index, TItem& item)
+{
+	// Claim one of the slots first so the bound holds across all deques.
+	size_t queued = _queued.load(std::memory_order_relaxed);
+	do
+	{
+		if (queued >= _slotCount)
+		{
+			return false;
+		}
+	} while (!_queued.compare_exchange_weak(queued, queued + 1, std::memory_order_relaxed));
+
+	Local& local = *_locals[index];
+	std::lock_guard<std::mutex> lock{ local.mutex };
+	local.items.push_back(std::move(item));
+	return true;
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void WorkStealingQueue<TItem, TAction, TOnDisconnect>::produce(TItem item)
+{
+	// A worker feeds its own deque; everyone else spreads round-robin.
+	size_t index = (t_owner == this)
+		? t_index
+		: _nextWorker.fetch_add(1, std::memory_order_relaxed) % _locals.size();
+
+	int spins = 0;
+	while (!try_push(index, item))
+	{
+		if (spins < _spinCount)
+		{
+			++spins;
+			cpu_relax();
+			continue;
+		}
+
+		// Park until a worker frees a slot.
+		_parkedProducers.fetch_add(1);
+		uint32_t seen = _popped.load();
+		bool pushed = try_push(index, item);
+		if (!pushed)
+		{
+			_popped.wait(seen);
+		}
+		_parkedProducers.fetch_sub(1);
+		if (pushed)
+		{
+			break;
+		}
+	}
+
+	// Announce available item.
+	_pushed.fetch_add(1);
+	if (_parkedConsumers.load() > 0)
+	{
+		_pushed.notify_one();
+	}
+	count(_counters.produced);
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+std::optional<TItem> WorkStealingQueue<TItem, TAction, TOnDisconnect>::take(size_t index)
+{
+	std::optional<TItem> result;
+	{
+		// Newest first from our own deque; it is the most likely to be in cache.
+		Local& local = *_locals[index];
+		std::lock_guard<std::mutex> lock{ local.mutex };
+		if (!local.items.empty())
+		{
+			result = std::move(local.items.back());
+			local.items.pop_back();
+		}
+	}
+
+	// Oldest first from everyone else's.
+	for (size_t k = 1; !result && k < _locals.size(); ++k)
+	{
+		Local& victim = *_locals[(index + k) % _locals.size()];
+		std::lock_guard<std::mutex> lock{ victim.mutex };
+		if (!victim.items.empty())
+		{
+			result = std::move(victim.items.front());
+			victim.items.pop_front();
+			count(_counters.stolen);
+		}
+	}
+
+	if (result)
+	{
+		// Announce available slot.
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+		_popped.fetch_add(1);
+		if (_parkedProducers.load() > 0)
+		{
+			_popped.notify_one();
+		}
+	}
+	return result;
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+std::optional<TItem> WorkStealingQueue<TItem, TAction, TOnDisconnect>::consume(size_t index)
+{
+	int spins = 0;
+	std::optional<TItem> result = take(index);
+	while (!result)
+	{
+		// Termination once disconnected and drained.
+		if (!_stay.load())
+		{
+			return result;
+		}
+
+		if (spins < _spinCount)
+		{
+			++spins;
+			cpu_relax();
+		}
+		else
+		{
+			// Park until something is produced or the queue is disconnected.
+			_parkedConsumers.fetch_add(1);
+			uint32_t seen = _pushed.load();
+			result = take(index);
+			if (!result && _stay.load())
+			{
+				count(_counters.parked);
+				_pushed.wait(seen);
+			}
+			_parkedConsumers.fetch_sub(1);
+			if (result)
+			{
+				break;
+			}
+		}
+		result = take(index);
+	}
+	return result;
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void WorkStealingQueue<TItem, TAction, TOnDisconnect>::work(WorkStealingQueue<TItem, TAction, TOnDisconnect>& tq, TAction& action, size_t index)
+{
+	t_owner = &tq;
+	t_index = index;
+
+	while (true)
+	{
+		std::optional<TItem> item = tq.consume(index);
+		if (!item)
+		{
+			// Termination of idle threads.
+			break;
+		}
+
+		if (!action(*item))
+		{
+			// Decision to terminate workers.
+			tq.disconnect();
+		}
+		tq.count(tq._counters.executed);
+	}
+
+	t_owner = nullptr;
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+void WorkStealingQueue<TItem, TAction, TOnDisconnect>::disconnect()
+{
+	_stay = false;
+	// Wake every parked worker so it can see _stay and exit.
+	_pushed.fetch_add(1);
+	_pushed.notify_all();
+	_onDisconnect();
+}
+
+template <typename TItem, typename TAction, typename TOnDisconnect>
+WorkStealingQueue<TItem, TAction, TOnDisconnect>::~WorkStealingQueue()
+{
+	disconnect();
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+#endif
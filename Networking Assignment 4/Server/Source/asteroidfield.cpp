@@ -0,0 +1,198 @@
+/******************************************************************************/
+/*!
+\file		asteroidfield.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Fixed-capacity structure-of-arrays asteroid pool
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "asteroidfield.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#define RESTRICT __restrict
+#else
+#define RESTRICT __restrict__
+#endif
+
+namespace
+{
+	/*
+	* brief: value += rate * dt over one array. The arrays never alias, so
+	*        the loop compiles to packed multiply-adds.
+	* param: value
+	* param: rate
+	* param: count
+	* param: dt
+	*/
+	void IntegrateAxis(float* RESTRICT value, const float* RESTRICT rate, size_t count, float dt)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			value[i] += rate[i] * dt;
+		}
+	}
+
+	void Advance(float* RESTRICT value, size_t count, float dt)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			value[i] += dt;
+		}
+	}
+}
+
+AsteroidField::AsteroidField(size_t capacity)
+{
+	capacity = std::min<size_t>(capacity, size_t{ SLOT_MASK } + 1);
+
+	_id.resize(capacity);
+	_size.resize(capacity);
+	_pos_x.resize(capacity);
+	_pos_y.resize(capacity);
+	_vel_x.resize(capacity);
+	_vel_y.resize(capacity);
+	_rot.resize(capacity);
+	_age.resize(capacity);
+
+	_generation.resize(capacity, 0);
+	_slot_dense.resize(capacity, 0);
+
+	// Lowest slots come off the stack first
+	_free.reserve(capacity);
+	for (size_t slot = capacity; slot-- > 0;)
+	{
+		_free.push_back(static_cast<uint32_t>(slot));
+	}
+}
+
+/*
+* brief: take a free slot and append the asteroid to the dense arrays
+* param: size
+* param: position
+* param: velocity
+* param: rotation
+* return: the asteroid's id, or INVALID_ID if the pool is full
+*/
+uint32_t AsteroidField::spawn(float size, Vec2 position, Vec2 velocity, float rotation)
+{
+	if (full())
+	{
+		return INVALID_ID;
+	}
+
+	uint32_t slot = _free.back();
+	_free.pop_back();
+
+	uint32_t id = (static_cast<uint32_t>(_generation[slot]) << SLOT_BITS) | slot;
+	size_t index = _count++;
+	_slot_dense[slot] = static_cast<uint32_t>(index);
+
+	_id[index] = id;
+	_size[index] = size;
+	_pos_x[index] = position.x;
+	_pos_y[index] = position.y;
+	_vel_x[index] = velocity.x;
+	_vel_y[index] = velocity.y;
+	_rot[index] = rotation;
+	_age[index] = 0.f;
+	return id;
+}
+
+/*
+* brief: remove one asteroid by id
+* param: id
+* return: false if the id is stale
+*/
+bool AsteroidField::despawn(uint32_t id)
+{
+	if (!alive(id))
+	{
+		return false;
+	}
+	remove(_slot_dense[id & SLOT_MASK]);
+	return true;
+}
+
+bool AsteroidField::alive(uint32_t id) const
+{
+	// A freed slot's generation has already moved past every id it issued.
+	uint32_t slot = id & SLOT_MASK;
+	return slot < _generation.size() && _generation[slot] == (id >> SLOT_BITS) && _id[_slot_dense[slot]] == id;
+}
+
+/*
+* brief: advance every asteroid by one fixed step
+* param: dt
+*/
+void AsteroidField::integrate(float dt)
+{
+	IntegrateAxis(_pos_x.data(), _vel_x.data(), _count, dt);
+	IntegrateAxis(_pos_y.data(), _vel_y.data(), _count, dt);
+	Advance(_age.data(), _count, dt);
+}
+
+/*
+* brief: drop asteroids that are too old or have left the given rectangle
+* param: max_age
+* param: min_x
+* param: max_x
+* param: min_y
+* param: max_y
+* return: number removed
+*/
+size_t AsteroidField::expire(float max_age, float min_x, float max_x, float min_y, float max_y)
+{
+	size_t removed = 0;
+	// Walk backwards so the asteroid moved into a freed index is one already checked.
+	for (size_t i = _count; i-- > 0;)
+	{
+		if (_age[i] > max_age ||
+			_pos_x[i] < min_x || _pos_x[i] > max_x || _pos_y[i] < min_y || _pos_y[i] > max_y)
+		{
+			remove(i);
+			++removed;
+		}
+	}
+	return removed;
+}
+
+ASTEROID AsteroidField::get(size_t index) const
+{
+	return ASTEROID(static_cast<int>(_id[index]), true, _size[index],
+		Vec2{ _pos_x[index], _pos_y[index] },
+		Vec2{ _vel_x[index], _vel_y[index] },
+		_rot[index]);
+}
+
+/*
+* brief: free the asteroid's slot and move the last dense entry into its place
+* param: index
+*/
+void AsteroidField::remove(size_t index)
+{
+	uint32_t slot = _id[index] & SLOT_MASK;
+	++_generation[slot];
+	_free.push_back(slot);
+
+	size_t last = --_count;
+	if (index != last)
+	{
+		_id[index] = _id[last];
+		_size[index] = _size[last];
+		_pos_x[index] = _pos_x[last];
+		_pos_y[index] = _pos_y[last];
+		_vel_x[index] = _vel_x[last];
+		_vel_y[index] = _vel_y[last];
+		_rot[index] = _rot[last];
+		_age[index] = _age[last];
+		_slot_dense[_id[index] & SLOT_MASK] = static_cast<uint32_t>(index);
+	}
+}
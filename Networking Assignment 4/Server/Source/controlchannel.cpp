@@ -0,0 +1,294 @@
+/******************************************************************************/
+/*!
+\file		controlchannel.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Readiness-driven, length-prefixed TCP control channel
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "controlchannel.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "server.h"
+
+void ReceiveRing::consume(size_t count)
+{
+	_read += count;
+	if (_read == _write)
+	{
+		_read = 0;
+		_write = 0;
+	}
+}
+
+char* ReceiveRing::space()
+{
+	if (_write == _bytes.size() && _read > 0)
+	{
+		memmove(_bytes.data(), _bytes.data() + _read, _write - _read);
+		_write -= _read;
+		_read = 0;
+	}
+	return _bytes.data() + _write;
+}
+
+ControlChannel::ControlChannel(EventLoop& event_loop) :
+	_event_loop{ event_loop }
+{
+	_send_buffer.reserve(FRAME_HEADER_SIZE + MAX_FRAME_SIZE);
+}
+
+ControlChannel::~ControlChannel()
+{
+	while (!_connections.empty())
+	{
+		close(_connections.begin()->first);
+	}
+	if (_listener != INVALID_SOCKET)
+	{
+		_event_loop.remove(_listener);
+		closesocket(_listener);
+	}
+}
+
+/*
+* brief: open the listener
+* param: port
+*/
+bool ControlChannel::listen(uint16_t port)
+{
+	_listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (_listener == INVALID_SOCKET)
+	{
+		std::cerr << "control socket() failed." << std::endl;
+		return false;
+	}
+
+	int reuse = 1;
+	setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+	sockaddr_in local_endpoint{};
+	local_endpoint.sin_family = AF_INET;
+	local_endpoint.sin_addr.s_addr = htonl(INADDR_ANY);
+	local_endpoint.sin_port = htons(port);
+
+	if (bind(_listener, (SOCKADDR*)&local_endpoint, sizeof(local_endpoint)) != NO_ERROR ||
+		::listen(_listener, SOMAXCONN) != NO_ERROR ||
+		!set_nonblocking(_listener, true) ||
+		!_event_loop.add(_listener))
+	{
+		std::cerr << "control listener setup failed with error: " << WSAGetLastError() << std::endl;
+		closesocket(_listener);
+		_listener = INVALID_SOCKET;
+		return false;
+	}
+	return true;
+}
+
+bool ControlChannel::owns(SOCKET socket) const
+{
+	return socket == _listener || _connections.count(socket) != 0;
+}
+
+void ControlChannel::on_ready(SOCKET socket)
+{
+	if (socket == _listener)
+	{
+		accept_all();
+		return;
+	}
+
+	auto connection = _connections.find(socket);
+	if (connection != _connections.end() && !read(socket, *connection->second))
+	{
+		close(socket);
+	}
+}
+
+/*
+* brief: accept every pending connection and add it to the roster
+*/
+void ControlChannel::accept_all()
+{
+	while (true)
+	{
+		sockaddr_storage addr{};
+		socklen_t addrLen = sizeof(addr);
+		SOCKET client = accept(_listener, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+		if (client == INVALID_SOCKET)
+		{
+			int errorCode = WSAGetLastError();
+			if (!would_block(errorCode))
+			{
+				std::cerr << "accept failed with error: " << errorCode << '\n';
+			}
+			return;
+		}
+
+		if (!set_nonblocking(client, true) || !_event_loop.add(client))
+		{
+			closesocket(client);
+			continue;
+		}
+
+		auto connection = std::make_unique<Connection>();
+		connection->key = MakeEndpointKey(addr);
+		_roster.add(connection->key);
+		_connections.emplace(client, std::move(connection));
+	}
+}
+
+/*
+* brief: drain the socket into the ring and handle every complete frame
+* param: socket
+* param: connection
+* return: false on disconnect, error or a malformed frame
+*/
+bool ControlChannel::read(SOCKET socket, Connection& connection)
+{
+	ReceiveRing& ring = connection.ring;
+	while (true)
+	{
+		char* space = ring.space();
+		if (ring.space_size() == 0)
+		{
+			// Cannot happen with MAX_FRAME_SIZE enforced below; bail rather than spin.
+			return false;
+		}
+
+		int bytesReceived = recv(socket, space, static_cast<int>(ring.space_size()), 0);
+		if (bytesReceived == SOCKET_ERROR)
+		{
+			return would_block(WSAGetLastError());
+		}
+		if (bytesReceived == 0)
+		{
+			return false;
+		}
+		ring.commit(static_cast<size_t>(bytesReceived));
+
+		while (ring.size() >= FRAME_HEADER_SIZE)
+		{
+			uint32_t length;
+			memcpy(&length, ring.data(), sizeof(length));
+			length = ntohl(length);
+			if (length == 0 || length > MAX_FRAME_SIZE)
+			{
+				std::cerr << "control frame of " << length << " bytes from "
+					<< EndpointKeyString(connection.key) << " rejected\n";
+				return false;
+			}
+			if (ring.size() < FRAME_HEADER_SIZE + length)
+			{
+				break;
+			}
+
+			if (!handle_frame(socket, ring.data() + FRAME_HEADER_SIZE, length))
+			{
+				return false;
+			}
+			ring.consume(FRAME_HEADER_SIZE + length);
+		}
+	}
+}
+
+/*
+* brief: act on one complete frame body
+* param: socket
+* param: frame
+* param: size
+* return: false if the connection should be closed
+*/
+bool ControlChannel::handle_frame(SOCKET socket, const char* frame, size_t size)
+{
+	(void)size;
+	CMDID cmd_id = static_cast<CMDID>(static_cast<uint8_t>(frame[0]));
+	switch (cmd_id)
+	{
+	case REQ_QUIT:
+		return false;
+	case REQ_LISTUSERS:
+		return respond_list_user(socket);
+	default:
+		return send_unknown(socket);
+	}
+}
+
+void ControlChannel::close(SOCKET socket)
+{
+	auto connection = _connections.find(socket);
+	if (connection == _connections.end())
+	{
+		return;
+	}
+
+	_roster.remove(connection->second->key);
+	_connections.erase(connection);
+
+	_event_loop.remove(socket);
+	shutdown(socket, SD_BOTH);
+	closesocket(socket);
+}
+
+/*
+* brief: send bytes that are already framed. Replies are a few hundred bytes
+*        at most, so a peer that will not take them is treated as gone
+*        rather than buffered for.
+* param: socket
+* param: data
+* param: size
+*/
+bool ControlChannel::send_all(SOCKET socket, const char* data, size_t size)
+{
+	size_t sent = 0;
+	while (sent < size)
+	{
+		int bytesSent = send(socket, data + sent, static_cast<int>(size - sent), MSG_NOSIGNAL);
+		if (bytesSent <= 0)
+		{
+			return false;
+		}
+		sent += static_cast<size_t>(bytesSent);
+	}
+	return true;
+}
+
+/*
+* brief: prefix the body with its length and send it whole
+* param: socket
+* param: body
+* param: size
+*/
+bool ControlChannel::send_frame(SOCKET socket, const char* body, size_t size)
+{
+	uint32_t length = htonl(static_cast<uint32_t>(size));
+	_send_buffer.resize(FRAME_HEADER_SIZE + size);
+	memcpy(_send_buffer.data(), &length, sizeof(length));
+	memcpy(_send_buffer.data() + FRAME_HEADER_SIZE, body, size);
+
+	return send_all(socket, _send_buffer.data(), _send_buffer.size());
+}
+
+/*
+* brief: send the cached RSP_LISTUSERS frame
+* param: socket
+*/
+bool ControlChannel::respond_list_user(SOCKET socket)
+{
+	RosterImage::Image image = _roster.image();
+	return send_all(socket, image->data(), image->size());
+}
+
+bool ControlChannel::send_unknown(SOCKET socket)
+{
+	char body = static_cast<char>(UNKNOWN);
+	return send_frame(socket, &body, sizeof(body));
+}
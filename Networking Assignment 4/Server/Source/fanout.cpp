@@ -0,0 +1,219 @@
+/******************************************************************************/
+/*!
+\file		fanout.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Snapshot fan-out stage (sendmmsg on Linux, sendto loop elsewhere)
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "fanout.h"
+
+Fanout::Fanout(SOCKET socket) :
+	_socket{ socket }
+{
+}
+
+/*
+* brief: forget every destination
+*/
+void Fanout::clear_destinations()
+{
+	_destinations.clear();
+#ifdef __linux__
+	_messages.clear();
+#endif
+}
+
+/*
+* brief: add a client address to the batch
+* param: address
+*/
+void Fanout::add_destination(const sockaddr_in& address)
+{
+	_destinations.push_back(address);
+
+#ifdef __linux__
+	// Every message shares the one payload iovec; only msg_name differs.
+	_messages.resize(_destinations.size());
+	for (size_t i = 0; i < _destinations.size(); ++i)
+	{
+		msghdr& header = _messages[i].msg_hdr;
+		header = {};
+		header.msg_name = &_destinations[i];
+		header.msg_namelen = sizeof(sockaddr_in);
+		header.msg_iov = &_payload;
+		header.msg_iovlen = 1;
+	}
+#endif
+}
+
+/*
+* brief: send one payload to every destination
+* param: data
+* param: size
+*/
+int Fanout::send(const char* data, size_t size)
+{
+	if (_destinations.empty())
+	{
+		return 0;
+	}
+
+#ifdef __linux__
+	_payload.iov_base = const_cast<char*>(data);
+	_payload.iov_len = size;
+	return submit(_messages.data(), _messages.size());
+#else
+	int sent = 0;
+	int failed = 0;
+	for (const sockaddr_in& address : _destinations)
+	{
+		if (sendto(_socket, data, static_cast<int>(size), 0, (const SOCKADDR*)&address, sizeof(address)) != SOCKET_ERROR)
+		{
+			++sent;
+		}
+		else if (!would_block(WSAGetLastError()))
+		{
+			++failed;
+		}
+	}
+	count(static_cast<int>(_destinations.size()), sent, failed);
+	return sent;
+#endif
+}
+
+/*
+* brief: queue a payload for one address
+* param: data
+* param: size
+* param: address
+*/
+void Fanout::queue(const char* data, size_t size, const sockaddr_in& address)
+{
+	_queued.push_back({ data, size, address });
+}
+
+/*
+* brief: send everything queued since the last flush
+*/
+int Fanout::flush()
+{
+	if (_queued.empty())
+	{
+		return 0;
+	}
+
+#ifdef __linux__
+	// Headers are built here, once _queued has stopped growing.
+	_queued_messages.resize(_queued.size());
+	_queued_payloads.resize(_queued.size());
+	for (size_t i = 0; i < _queued.size(); ++i)
+	{
+		_queued_payloads[i].iov_base = const_cast<char*>(_queued[i].data);
+		_queued_payloads[i].iov_len = _queued[i].size;
+
+		msghdr& header = _queued_messages[i].msg_hdr;
+		header = {};
+		header.msg_name = &_queued[i].address;
+		header.msg_namelen = sizeof(sockaddr_in);
+		header.msg_iov = &_queued_payloads[i];
+		header.msg_iovlen = 1;
+	}
+	int sent = submit(_queued_messages.data(), _queued_messages.size());
+#else
+	int sent = 0;
+	int failed = 0;
+	for (const Queued& queued : _queued)
+	{
+		if (sendto(_socket, queued.data, static_cast<int>(queued.size), 0, (const SOCKADDR*)&queued.address, sizeof(queued.address)) != SOCKET_ERROR)
+		{
+			++sent;
+		}
+		else if (!would_block(WSAGetLastError()))
+		{
+			++failed;
+		}
+	}
+	count(static_cast<int>(_queued.size()), sent, failed);
+#endif
+
+	_queued.clear();
+	return sent;
+}
+
+#ifdef __linux__
+/*
+* brief: hand a batch to sendmmsg, resubmitting whatever it did not accept.
+*        sendmmsg stops at the first message that fails and reports that
+*        failure only when it is the first of the call, so a message that
+*        fails for its own sake (an unreachable address, say) is skipped and
+*        the rest still go out. Only a full socket buffer ends the batch.
+* param: messages
+* param: message_count
+*/
+int Fanout::submit(mmsghdr* messages, size_t message_count)
+{
+	int sent = 0;
+	int syscalls = 0;
+	int failed = 0;
+	size_t offset = 0;
+	while (offset < message_count)
+	{
+		int accepted = sendmmsg(_socket, messages + offset, static_cast<unsigned int>(message_count - offset), 0);
+		++syscalls;
+		if (accepted < 0)
+		{
+			int errorCode = WSAGetLastError();
+			if (errorCode == EINTR)
+			{
+				continue;
+			}
+			if (would_block(errorCode))
+			{
+				break;
+			}
+			++offset;
+			++failed;
+			continue;
+		}
+		if (accepted == 0)
+		{
+			break;
+		}
+		offset += static_cast<size_t>(accepted);
+		sent += accepted;
+	}
+	count(syscalls, sent, failed);
+	return sent;
+}
+#endif
+
+/*
+* brief: add to the per-tick and total counters
+* param: syscalls
+* param: datagrams
+* param: failed
+*/
+void Fanout::count(int syscalls, int datagrams, int failed)
+{
+	_total_failed += static_cast<uint64_t>(failed);
+	_tick_syscalls += static_cast<uint64_t>(syscalls);
+	_total_syscalls += static_cast<uint64_t>(syscalls);
+	_tick_datagrams += static_cast<uint64_t>(datagrams);
+	_total_datagrams += static_cast<uint64_t>(datagrams);
+}
+
+/*
+* brief: reset the per-tick counters
+*/
+void Fanout::begin_tick()
+{
+	_tick_datagrams = 0;
+	_tick_syscalls = 0;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************/
+/*!
+\file		fragment.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Splitting messages into FRAGMENT datagrams
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "fragment.h"
+
+#include <algorithm>
+#include <cstring>
+
+size_t FragmentMessage(const char* data, size_t size, uint32_t message_id, std::vector<char>& out)
+{
+	out.clear();
+	if (size == 0 || size > MAX_FRAGMENTED_SIZE)
+	{
+		return 0;
+	}
+
+	size_t count = (size + FRAGMENT_PAYLOAD_SIZE - 1) / FRAGMENT_PAYLOAD_SIZE;
+	out.resize(size + count * FRAGMENT_HEADER_SIZE);
+
+	// The message starts with its own CMDID; it names the stream it is reassembled in
+	const CMDID ID = FRAGMENT;
+	CMDID messageCommand = UNKNOWN;
+	memcpy(&messageCommand, data, std::min(size, sizeof(messageCommand)));
+	uint8_t command = static_cast<uint8_t>(messageCommand);
+	uint8_t fragmentCount = static_cast<uint8_t>(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		char* fragment = out.data() + i * MAX_DATAGRAM_SIZE;
+		size_t offset = i * FRAGMENT_PAYLOAD_SIZE;
+		size_t payload = std::min(FRAGMENT_PAYLOAD_SIZE, size - offset);
+		uint8_t index = static_cast<uint8_t>(i);
+
+		char* field = fragment;
+		memcpy(field, &ID, sizeof(ID));
+		field += sizeof(ID);
+		memcpy(field, &command, sizeof(command));
+		field += sizeof(command);
+		memcpy(field, &message_id, sizeof(message_id));
+		field += sizeof(message_id);
+		memcpy(field, &index, sizeof(index));
+		field += sizeof(index);
+		memcpy(field, &fragmentCount, sizeof(fragmentCount));
+		memcpy(fragment + FRAGMENT_HEADER_SIZE, data + offset, payload);
+	}
+	return count;
+}
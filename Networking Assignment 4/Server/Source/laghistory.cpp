@@ -0,0 +1,105 @@
+/******************************************************************************/
+/*!
+\file		laghistory.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Lag-compensation history ring
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "laghistory.h"
+
+#include <algorithm>
+
+LagHistory::LagHistory(size_t entity_slots, size_t frames) :
+	_slots{ entity_slots },
+	_frames{ std::max<size_t>(frames, 2) },
+	_head{ _frames - 1 },
+	_times(_frames, 0.0),
+	_samples(_slots * _frames, Sample{ NO_ENTITY, 0.f, 0.f, 0.f })
+{
+}
+
+void LagHistory::begin_frame(double time)
+{
+	_head = (_head + 1) % _frames;
+	_times[_head] = time;
+	_recorded = std::min(_recorded + 1, _frames);
+
+	for (size_t slot = 0; slot < _slots; ++slot)
+	{
+		_samples[slot * _frames + _head].id = NO_ENTITY;
+	}
+}
+
+void LagHistory::store(size_t slot, uint32_t id, Vec2 position, float radius)
+{
+	if (slot < _slots && _recorded > 0)
+	{
+		_samples[slot * _frames + _head] = Sample{ id, position.x, position.y, radius };
+	}
+}
+
+/*
+* brief: position of one entity at a past time
+* param: slot
+* param: id
+* param: time
+* param: position
+* param: radius
+*/
+bool LagHistory::rewind(size_t slot, uint32_t id, double time, Vec2& position, float& radius) const
+{
+	if (slot >= _slots || _recorded == 0 || time < oldest_time())
+	{
+		return false;
+	}
+
+	const Sample* samples = _samples.data() + slot * _frames;
+	if (time >= newest_time())
+	{
+		const Sample& newest = samples[_head];
+		if (newest.id != id)
+		{
+			return false;
+		}
+		position = { newest.x, newest.y };
+		radius = newest.radius;
+		return true;
+	}
+
+	// First frame newer than time; the one before it is at or older than time.
+	size_t low = 0;
+	size_t high = _recorded - 1;
+	while (low < high)
+	{
+		size_t middle = (low + high) / 2;
+		if (_times[physical(middle)] > time)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle + 1;
+		}
+	}
+
+	size_t after = physical(low);
+	size_t before = physical(low - 1);
+	const Sample& a = samples[before];
+	const Sample& b = samples[after];
+	if (a.id != id || b.id != id)
+	{
+		return false;
+	}
+
+	float t = static_cast<float>((time - _times[before]) / (_times[after] - _times[before]));
+	position = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+	radius = a.radius + (b.radius - a.radius) * t;
+	return true;
+}
@@ -0,0 +1,722 @@
+/******************************************************************************/
+/*!
+\file		match.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		One 4-player game and the state it owns
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "match.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "fragment.h"
+#include "wireformat.h"
+
+namespace
+{
+	//=====================================================================================
+	//FOR AESTEROIDS
+	const int			ASTEROID_SCORE = 300;			// score per asteroid destroyed
+	const float			ASTEROID_SIZE = 70.0f;		// asteroid size
+	const float			ASTEROID_SPEED = 100.0f;		// maximum asteroid speed
+	const float			ASTEROID_TIME = 2.0f;			// 2 second spawn time for asteroids
+	const int			ASTEROID_MAX = 50;			// most asteroids alive in one match
+	const float			ASTEROID_LIFETIME = 30.0f;	// seconds before an asteroid expires
+	const uint32_t		ASTEROID_SEND_INTERVAL = 6;	// ticks between asteroid broadcasts
+
+	const int			WINDOW_WIDTH = 800;
+	const int			WINDOW_HEIGHT = 600;
+
+	// Half the client's SHIP_SIZE and BULLET_SIZE boxes
+	const float			SHIP_RADIUS = 8.0f;
+	const float			BULLET_HALF_SIZE = 10.0f;
+	// Room for quantization and a frame of motion between the client's
+	// collision and the position it reports
+	const float			HIT_SLACK = 12.0f;
+
+	// The most bullets one SEND_PLAYERS can carry
+	const size_t SEND_PLAYERS_HEADER_SIZE = sizeof(CMDID) + sizeof(uint32_t);
+	const size_t MAX_BULLETS_PER_PACKET = std::min<size_t>(
+		((RECEIVE_BUFFER_SIZE - SEND_PLAYERS_HEADER_SIZE) * 8 - PlayerBits() - WIRE_FORMAT.bullet_count_bits) / BulletBits(),
+		(1u << WIRE_FORMAT.bullet_count_bits) - 1);
+
+	// Snapshots kept to diff against; a client acking anything older gets a full snapshot
+	const size_t SNAPSHOT_HISTORY_SIZE = 32;
+
+	// Lowest snapshot rate an over-budget client is cut to: one every this many ticks
+	const uint32_t MAX_SNAPSHOT_INTERVAL = 8;
+
+	// Snapshots sent to a client per loss sample
+	const uint32_t LOSS_WINDOW = 64;
+	// Round trips above this land in the histogram's last bucket, in microseconds
+	const uint64_t RTT_HISTOGRAM_MAX_US = 10'000'000;
+
+	void Vec2Set(Vec2* vec, float x, float y) {
+		vec->x = x;
+		vec->y = y;
+	}
+
+	void Vec2Scale(Vec2* result, const Vec2* vec, float scale) {
+		result->x = vec->x * scale;
+		result->y = vec->y * scale;
+	}
+}
+
+Match::Match(uint32_t id, SOCKET socket, int tick_rate, uint32_t client_budget) :
+	_id{ id },
+	_client_budget{ client_budget },
+	_players(MAX_PLAYERS),
+	_bullets(MAX_PLAYERS),
+	_asteroids{ ASTEROID_MAX },
+	_history{ MAX_PLAYERS + ASTEROID_MAX, static_cast<size_t>(std::ceil(LAG_COMPENSATION_SECONDS * std::max(tick_rate, 1))) + 2 },
+	_hits_confirmed{ &Metrics().counter("server_asteroid_hits_total",
+		"Asteroid hits claimed by clients, by whether the rewound world agreed", "result=\"confirmed\"") },
+	_hits_rejected{ &Metrics().counter("server_asteroid_hits_total",
+		"Asteroid hits claimed by clients, by whether the rewound world agreed", "result=\"rejected\"") },
+	_random{ id + 1 },
+	_fanout{ socket },
+	_paced(PACING_SLOTS),
+	_snapshot_history(SNAPSHOT_HISTORY_SIZE, MAX_PLAYERS, MAX_BULLETS_PER_PACKET),
+	_snapshot_sent_at(SNAPSHOT_HISTORY_SIZE),
+	_snapshot_buffers(MAX_PLAYERS),
+	_snapshot_fragments(MAX_PLAYERS),
+	_rtt_histogram{ &Metrics().histogram("server_snapshot_rtt_seconds",
+		"Snapshot send to acknowledgement, including up to a tick of queueing at each end", "",
+		RTT_HISTOGRAM_MAX_US, 1e-6) }
+{
+	_clients.reserve(MAX_PLAYERS);
+	_pacing.reserve(MAX_PLAYERS);
+	_session_stats.reserve(MAX_PLAYERS);
+	for (auto& slot : _paced)
+	{
+		slot.reserve(MAX_PLAYERS * 2);
+	}
+	for (auto& buffer : _snapshot_buffers)
+	{
+		buffer.reserve(RECEIVE_BUFFER_SIZE);
+	}
+}
+
+Match::~Match()
+{
+	// Seats that never left still have their series registered
+	for (const SessionStats& stats : _session_stats)
+	{
+		if (stats.rtt != nullptr)
+		{
+			Metrics().remove("server_session_rtt_seconds", stats.labels);
+			Metrics().remove("server_session_snapshot_loss_ratio", stats.labels);
+		}
+	}
+}
+
+/*
+* brief: seat a client and answer its handshake with its player number
+* param: address
+*/
+uint16_t Match::join(const sockaddr_in& address)
+{
+	// Clients number themselves from 0; the server's player_num starts at 1.
+	std::string player_num = std::to_string(_clients.size());
+	const char* responseMessage = player_num.c_str();
+	sendto(_fanout.socket(), responseMessage, strlen(responseMessage), 0, (const SOCKADDR*)&address, sizeof(address));
+	_sent_tally.add_handshake(strlen(responseMessage));
+
+	uint16_t seat = static_cast<uint16_t>(_clients.size() + 1);
+	_clients.push_back({ address, true, seat });
+	// A quarter second of burst, but always room for the largest datagram
+	float rate = static_cast<float>(_client_budget);
+	_pacing.push_back({ TokenBucket(rate, std::max(rate / 4.0f, static_cast<float>(RECEIVE_BUFFER_SIZE))) });
+	_bullets[seat - 1].reserve(MAX_BULLETS_PER_PACKET);
+
+	std::string labels = "match=\"" + std::to_string(_id) + "\",player=\"" + std::to_string(seat) + "\"";
+	_session_stats.push_back({
+		&Metrics().gauge("server_session_rtt_seconds", "Smoothed snapshot round trip per session", labels),
+		&Metrics().gauge("server_session_snapshot_loss_ratio", "Share of the last snapshots sent that were never acknowledged", labels),
+		labels });
+	_fanout.add_destination(address);
+	return seat;
+}
+
+/*
+* brief: tell every seated client the game has started
+*/
+void Match::start()
+{
+	std::string max_player_num = std::to_string(MAX_PLAYERS);
+	_fanout.send(max_player_num.c_str(), max_player_num.size());
+	_sent_tally.add_handshake(max_player_num.size(), _fanout.destination_count());
+}
+
+/*
+* brief: decode one datagram from a seated client into that client's slot
+* param: player_num
+* param: data
+* param: size
+*/
+void Match::receive(uint16_t player_num, const char* data, size_t size)
+{
+	if (player_num == 0 || player_num > _clients.size())
+	{
+		return;
+	}
+	ClientInfo& client = _clients[player_num - 1];
+	if (!client.isConnected)
+	{
+		return;
+	}
+
+	CMDID receive_id;
+	if (size < sizeof(receive_id))
+	{
+		return;
+	}
+	memcpy(&receive_id, data, sizeof(receive_id));
+
+	switch (receive_id)
+	{
+	case SEND_PLAYERS: {
+		if (size < SEND_PLAYERS_HEADER_SIZE)
+		{
+			break;
+		}
+
+		Player& player = _players[client.player_num - 1];
+		std::vector<Bullet>& playerBullets = _bullets[client.player_num - 1];
+
+		// Newest snapshot the client has applied; the next delta is built on it.
+		uint32_t acked_sequence;
+		memcpy(&acked_sequence, data + sizeof(receive_id), sizeof(acked_sequence));
+		if (acked_sequence > client.acked_sequence && acked_sequence <= _snapshot_sequence)
+		{
+			client.acked_sequence = acked_sequence;
+			on_ack(client.player_num, acked_sequence);
+		}
+
+		BitReader in(data + SEND_PLAYERS_HEADER_SIZE, size - SEND_PLAYERS_HEADER_SIZE);
+		Player incoming{};
+		ReadPlayer(in, incoming);
+		size_t bulletCount = std::min<size_t>(in.read(WIRE_FORMAT.bullet_count_bits), MAX_BULLETS_PER_PACKET);
+		if (!in.ok())
+		{
+			break;
+		}
+		player = incoming;
+
+		// Capacity was reserved on join, so this never reallocates.
+		// Never trust the count beyond the bullets that actually arrived.
+		playerBullets.resize(bulletCount);
+		for (size_t i = 0; i < bulletCount; ++i)
+		{
+			ReadBullet(in, playerBullets[i]);
+			if (!in.ok())
+			{
+				playerBullets.resize(i);
+				break;
+			}
+		}
+		player.num_bullets = static_cast<int>(playerBullets.size());
+		break;
+	}
+
+	case SEND_ASTEROIDS:
+		// The server owns the asteroid field; uploads from older clients are ignored.
+		break;
+
+	case ASTEROID_HIT: {
+		// CMDID, uint32 asteroid id, then the bullet's position bit-packed
+		uint32_t asteroid_id;
+		size_t headerSize = sizeof(receive_id) + sizeof(asteroid_id);
+		if (size < headerSize)
+		{
+			break;
+		}
+		memcpy(&asteroid_id, data + sizeof(receive_id), sizeof(asteroid_id));
+
+		BitReader in(data + headerSize, size - headerSize);
+		Vec2 position = ReadPosition(in);
+		if (!in.ok())
+		{
+			break;
+		}
+
+		if (evaluate_shot(client.player_num, asteroid_id, position))
+		{
+			// Gone for everyone from the next RECEIVE_ASTEROIDS on
+			_asteroids.despawn(asteroid_id);
+			_hits_confirmed->add();
+		}
+		else
+		{
+			_hits_rejected->add();
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+/*
+* brief: stop sending to a seat and unregister its session series. The seat
+*        stays in _clients so every other player_num keeps its index.
+* param: player_num
+*/
+void Match::leave(uint16_t player_num)
+{
+	if (player_num == 0 || player_num > _clients.size() || !_clients[player_num - 1].isConnected)
+	{
+		return;
+	}
+	_clients[player_num - 1].isConnected = false;
+	_bullets[player_num - 1].clear();
+
+	_fanout.clear_destinations();
+	for (const ClientInfo& client : _clients)
+	{
+		if (client.isConnected)
+		{
+			_fanout.add_destination(client.address);
+		}
+	}
+
+	SessionStats& stats = _session_stats[player_num - 1];
+	Metrics().remove("server_session_rtt_seconds", stats.labels);
+	Metrics().remove("server_session_snapshot_loss_ratio", stats.labels);
+	stats.rtt = nullptr;
+	stats.loss = nullptr;
+}
+
+bool Match::abandoned() const
+{
+	return std::none_of(_clients.begin(), _clients.end(), [](const ClientInfo& client) { return client.isConnected; });
+}
+
+/*
+* brief: run the due simulation steps and send one snapshot
+* param: steps
+* param: dt
+*/
+void Match::tick(int steps, float dt)
+{
+	_fanout.begin_tick();
+
+	// Catch up on simulation after an overrun, but send only one snapshot.
+	for (int step = 0; step < steps; ++step)
+	{
+		simulate(dt);
+	}
+	record_history();
+
+	for (Pacing& pacing : _pacing)
+	{
+		pacing.budget.refill(dt * static_cast<float>(steps));
+	}
+
+	send_snapshot();
+
+	// Asteroids fly in straight lines, so clients extrapolate between broadcasts.
+	if (++_ticks_since_asteroids >= ASTEROID_SEND_INTERVAL)
+	{
+		_ticks_since_asteroids = 0;
+		send_asteroids();
+	}
+
+	send_paced(0);
+}
+
+/*
+* brief: send one pacing slot's datagrams as a single fan-out batch
+* param: slot
+*/
+void Match::send_paced(int slot)
+{
+	std::vector<PacedSend>& sends = _paced[slot];
+	if (sends.empty())
+	{
+		return;
+	}
+
+	for (const PacedSend& send : sends)
+	{
+		_fanout.queue(send.data, send.size, send.address);
+		_sent_tally.add(send.data, send.size);
+	}
+	_fanout.flush();
+	sends.clear();
+}
+
+/*
+* brief: split a message that does not fit one datagram
+* param: message
+* param: message_id
+* param: fragments
+* return: false if the message is too big even for MAX_FRAGMENTS fragments
+*/
+bool Match::fragment(const std::vector<char>& message, uint32_t& message_id, std::vector<char>& fragments)
+{
+	if (message.size() <= MAX_DATAGRAM_SIZE)
+	{
+		fragments.clear();
+		return true;
+	}
+
+	size_t count = FragmentMessage(message.data(), message.size(), ++message_id, fragments);
+	if (count == 0)
+	{
+		++_messages_oversized;
+		return false;
+	}
+	++_fragmented_messages;
+	_fragments_built += count;
+	return true;
+}
+
+/*
+* brief: spend the client's budget on a message and queue it in the client's
+*        pacing slot. Both buffers must stay valid until that slot is sent.
+* param: client
+* param: message
+* param: fragments
+* return: false if the client cannot afford it this tick
+*/
+bool Match::pace(const ClientInfo& client, const std::vector<char>& message, const std::vector<char>& fragments)
+{
+	// A fragmented message is all or nothing; charge every fragment up front.
+	const std::vector<char>& wire = fragments.empty() ? message : fragments;
+	if (!_pacing[client.player_num - 1].budget.try_consume(wire.size()))
+	{
+		++_sends_deferred;
+		return false;
+	}
+
+	// Spread clients over the slots so no single burst carries every datagram
+	std::vector<PacedSend>& slot = _paced[(client.player_num - 1) % PACING_SLOTS];
+	for (size_t offset = 0; offset < wire.size(); offset += MAX_DATAGRAM_SIZE)
+	{
+		slot.push_back({ wire.data() + offset, std::min(MAX_DATAGRAM_SIZE, wire.size() - offset), client.address });
+	}
+	return true;
+}
+
+/*
+* brief: check a claimed hit against the asteroid where the shooter saw it
+* param: player_num
+* param: asteroid_id
+* param: position
+*/
+bool Match::evaluate_shot(uint16_t player_num, uint32_t asteroid_id, Vec2 position) const
+{
+	if (player_num == 0 || player_num > _session_stats.size() || !_asteroids.alive(asteroid_id) || _history.recorded() == 0)
+	{
+		return false;
+	}
+
+	// The client draws the field about one trip behind the server. Until
+	// there is a round-trip sample, judge against the newest frame.
+	double latency = std::max(_session_stats[player_num - 1].smoothed_rtt, 0.0) / 2.0;
+	double when = _time - std::min(latency, LAG_COMPENSATION_SECONDS);
+	when = std::max(when, _history.oldest_time());
+
+	Vec2 centre;
+	float radius;
+	if (!_history.rewind(MAX_PLAYERS + AsteroidField::slot(asteroid_id), asteroid_id, when, centre, radius))
+	{
+		return false;
+	}
+
+	// The client tests the bullet's box against the asteroid's
+	float reach = radius + BULLET_HALF_SIZE + HIT_SLACK;
+	return std::fabs(position.x - centre.x) <= reach && std::fabs(position.y - centre.y) <= reach;
+}
+
+/*
+* brief: take a round-trip sample from the snapshot just acknowledged and
+*        count it towards the client's loss window
+* param: player_num
+* param: acked_sequence
+*/
+void Match::on_ack(uint16_t player_num, uint32_t acked_sequence)
+{
+	SessionStats& stats = _session_stats[player_num - 1];
+	++stats.window_acked;
+
+	// The send time has been overwritten once the snapshot leaves the history
+	if (_snapshot_sequence - acked_sequence >= SNAPSHOT_HISTORY_SIZE)
+	{
+		return;
+	}
+
+	auto rtt = std::chrono::steady_clock::now() - _snapshot_sent_at[acked_sequence % SNAPSHOT_HISTORY_SIZE];
+	int64_t rttUs = std::chrono::duration_cast<std::chrono::microseconds>(rtt).count();
+	_rtt_histogram->record(static_cast<uint64_t>(std::max<int64_t>(rttUs, 0)));
+
+	double sample = static_cast<double>(rttUs) * 1e-6;
+	stats.smoothed_rtt = stats.smoothed_rtt < 0.0 ? sample : stats.smoothed_rtt + (sample - stats.smoothed_rtt) / 8.0;
+	stats.rtt->set(stats.smoothed_rtt);
+}
+
+/*
+* brief: advance the simulation by one fixed step
+* param: dt
+*/
+void Match::simulate(float dt)
+{
+	_time += dt;
+	_asteroids.integrate(dt);
+
+	// Anything past the encodable range has left the play field for good.
+	_asteroids.expire(ASTEROID_LIFETIME, WIRE_FORMAT.position_x.min, WIRE_FORMAT.position_x.max,
+		WIRE_FORMAT.position_y.min, WIRE_FORMAT.position_y.max);
+
+	_asteroid_timer += dt;
+	if (_asteroid_timer > ASTEROID_TIME)
+	{
+		_asteroid_timer -= ASTEROID_TIME;
+		spawn_asteroids(1);
+	}
+}
+
+/*
+* brief: store where every ship and asteroid is at the end of this tick
+*/
+void Match::record_history()
+{
+	_history.begin_frame(_time);
+	for (const ClientInfo& client : _clients)
+	{
+		if (client.isConnected)
+		{
+			_history.store(client.player_num - 1, client.player_num, _players[client.player_num - 1].position, SHIP_RADIUS);
+		}
+	}
+	for (size_t i = 0; i < _asteroids.size(); ++i)
+	{
+		ASTEROID asteroid = _asteroids.get(i);
+		uint32_t id = static_cast<uint32_t>(asteroid._id);
+		_history.store(MAX_PLAYERS + AsteroidField::slot(id), id, asteroid._pos, asteroid._size / 2.0f);
+	}
+}
+
+/*
+* brief: record this tick's snapshot and queue each client a delta against the
+*        newest snapshot it acknowledged. Clients sharing a baseline share one
+*        encoded buffer. A client that cannot afford its snapshot is skipped
+*        and moved to a lower snapshot rate until its budget recovers.
+*/
+void Match::send_snapshot()
+{
+	WorldSnapshot& snapshot = _snapshot_history.push(++_snapshot_sequence);
+	_snapshot_sent_at[_snapshot_sequence % SNAPSHOT_HISTORY_SIZE] = std::chrono::steady_clock::now();
+	for (int i = 0; i < MAX_PLAYERS; ++i)
+	{
+		snapshot.players[i] = _players[i];
+		snapshot.bullets[i].assign(_bullets[i].begin(), _bullets[i].end());
+	}
+
+	size_t rawSize = RawSnapshotSize(snapshot);
+
+	// Baseline each buffer in _snapshot_buffers was encoded against, and
+	// whether it was small enough to send
+	uint32_t encodedBaselines[MAX_PLAYERS];
+	bool encodedSendable[MAX_PLAYERS];
+	size_t encodedCount = 0;
+
+	for (const auto& client : _clients)
+	{
+		if (!client.isConnected)
+		{
+			continue;
+		}
+
+		Pacing& pacing = _pacing[client.player_num - 1];
+		if (++pacing.ticks_since_snapshot < pacing.snapshot_interval)
+		{
+			continue;
+		}
+
+		const WorldSnapshot* baseline = _snapshot_history.find(client.acked_sequence);
+		uint32_t baselineSequence = baseline ? baseline->sequence : 0;
+
+		size_t index = 0;
+		while (index < encodedCount && encodedBaselines[index] != baselineSequence)
+		{
+			++index;
+		}
+		if (index == encodedCount)
+		{
+			EncodeSnapshotDelta(snapshot, baseline, _snapshot_buffers[index]);
+			encodedBaselines[index] = baselineSequence;
+			encodedSendable[index] = fragment(_snapshot_buffers[index], _snapshot_message_id, _snapshot_fragments[index]);
+			++encodedCount;
+		}
+		if (!encodedSendable[index])
+		{
+			continue;
+		}
+
+		// Deltas are against acked snapshots, so a skipped one costs nothing
+		// but staleness; the next one still applies cleanly.
+		const std::vector<char>& encoded = _snapshot_buffers[index];
+		if (!pace(client, encoded, _snapshot_fragments[index]))
+		{
+			pacing.snapshot_interval = std::min(pacing.snapshot_interval * 2, MAX_SNAPSHOT_INTERVAL);
+			continue;
+		}
+
+		pacing.ticks_since_snapshot = 0;
+
+		// A client acks only the newest snapshot it has applied, so this
+		// counts skipped acks as lost too; it is an upper bound on real loss.
+		SessionStats& stats = _session_stats[client.player_num - 1];
+		if (++stats.window_sent >= LOSS_WINDOW)
+		{
+			uint32_t acked = std::min(stats.window_acked, stats.window_sent);
+			stats.loss->set(1.0 - static_cast<double>(acked) / static_cast<double>(stats.window_sent));
+			stats.window_sent = 0;
+			stats.window_acked = 0;
+		}
+		if (pacing.snapshot_interval > 1 && pacing.budget.tokens() > pacing.budget.burst() / 2.0f)
+		{
+			--pacing.snapshot_interval;
+		}
+
+		_snapshot_bytes_sent += encoded.size();
+		_snapshot_bytes_raw += rawSize;
+	}
+}
+
+/*
+* brief: broadcast the whole asteroid field as one RECEIVE_ASTEROIDS
+*/
+void Match::send_asteroids()
+{
+
+	const CMDID ID = RECEIVE_ASTEROIDS;
+	uint16_t count = static_cast<uint16_t>(std::min<size_t>(_asteroids.size(), UINT16_MAX));
+
+	// CMDID, uint16 count, then the asteroids bit-packed
+	_asteroid_buffer.clear();
+	_asteroid_buffer.resize(sizeof(ID) + sizeof(count));
+	memcpy(_asteroid_buffer.data(), &ID, sizeof(ID));
+	memcpy(_asteroid_buffer.data() + sizeof(ID), &count, sizeof(count));
+
+	BitWriter out(_asteroid_buffer);
+	for (uint16_t i = 0; i < count; ++i)
+	{
+		WriteAsteroid(out, _asteroids.get(i));
+	}
+	out.flush();
+
+	if (!fragment(_asteroid_buffer, _asteroid_message_id, _asteroid_fragments))
+	{
+		return;
+	}
+
+	// Queue the byte array for every client that can afford it; the next
+	// broadcast carries the whole field again for any that cannot.
+	for (const auto& client : _clients)
+	{
+		if (client.isConnected)
+		{
+			pace(client, _asteroid_buffer, _asteroid_fragments);
+		}
+	}
+}
+
+/*
+* brief: uniform float in [0, 1] from this match's own generator, so matches
+*        on different workers never share random state
+*/
+float Match::rand_float()
+{
+	return static_cast<float>(_random() - _random.min()) / static_cast<float>(_random.max() - _random.min());
+}
+
+void Match::spawn_asteroids(unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		// for activating object instance
+		Vec2 pos, vel;
+
+		// random size
+		float size = rand_float() * ASTEROID_SIZE + ASTEROID_SIZE;
+
+		// random rotation
+		float rot = rand_float() * 360.0f;
+
+		// random direction
+		Vec2Set(&vel, cosf(rot), sinf(rot));
+
+		// random speed
+		int dir = (int)(rand_float() * 2.0f);
+		switch (dir)
+		{
+		case 0:
+
+		case 1:
+			Vec2Scale(&vel, &vel, ASTEROID_SPEED + rand_float() * ASTEROID_SPEED);
+			break;
+
+		case 2:
+			Vec2Scale(&vel, &vel, ASTEROID_SPEED - rand_float() * -ASTEROID_SPEED);
+			break;
+
+		default:
+			break;
+
+		}
+
+		// random position,   outside the window
+		// random window side
+		int side = (int)(rand_float() * 5.0f);
+
+		// set half window width and height global variables
+		float HALF_WIDTH = (float)WINDOW_WIDTH / 2.0f;	// half screen width
+
+		float HALF_HEIGHT = (float)WINDOW_HEIGHT / 2.0f;	// half screen height
+
+		// spawn   selected side
+		switch (side)
+		{
+		case 0: // fall through
+		case 1: //   top left
+			Vec2Set(&pos, (-rand_float() * HALF_WIDTH - size), (HALF_HEIGHT + size));
+			break;
+
+		case 2: //   top right
+			Vec2Set(&pos, (rand_float() * HALF_WIDTH + size), (HALF_HEIGHT + size));
+			break;
+
+		case 3: //   bottom left
+			Vec2Set(&pos, (-rand_float() * HALF_WIDTH - size), (-HALF_HEIGHT - size));
+			break;
+
+		case 4:
+
+		case 5: //   bottom right
+			Vec2Set(&pos, (rand_float() * HALF_WIDTH + size), (-HALF_HEIGHT - size));
+			break;
+
+		default:
+			break;
+
+		}
+
+		// spawn asteroid into the pool; a full pool just skips this one
+		_asteroids.spawn(size, pos, vel, rot);
+	}
+}
@@ -0,0 +1,290 @@
+/******************************************************************************/
+/*!
+\file		matchworker.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Worker thread that ticks the matches pinned to it
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "matchworker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+	// Datagram bytes a worker will hold between two ticks before dropping
+	const size_t MAX_INBOX_BYTES = 256 * 1024;
+
+	// Ticks longer than this land in the histogram's last bucket, in microseconds
+	const uint64_t TICK_HISTOGRAM_MAX_US = 1'000'000;
+
+	// Keeps report lines from different workers whole
+	std::mutex stdout_mutex;
+}
+
+void MatchWorker::Inbox::clear()
+{
+	bytes.clear();
+	entries.clear();
+	departures.clear();
+	adopted.clear();
+}
+
+void MatchWorker::MatchTotals::add(const Match& match)
+{
+	datagrams += match.fanout().total_datagrams();
+	syscalls += match.fanout().total_syscalls();
+	saved += match.fanout().total_syscalls_saved();
+	failed += match.fanout().total_failed();
+	sent += match.snapshot_bytes_sent();
+	raw += match.snapshot_bytes_raw();
+	deferred += match.sends_deferred();
+	fragmented += match.fragmented_messages();
+	fragments += match.fragments_built();
+	oversized += match.messages_oversized();
+}
+
+MatchWorker::MatchWorker(size_t index, int tick_rate, int max_catch_up) :
+	_index{ index },
+	_scheduler{ tick_rate, max_catch_up },
+	_tick_duration{ &Metrics().histogram("server_tick_duration_seconds",
+		"Time to apply the inbox and tick every match", "worker=\"" + std::to_string(index) + "\"",
+		TICK_HISTOGRAM_MAX_US, 1e-6) },
+	_match_gauge{ &Metrics().gauge("server_matches", "Matches running", "worker=\"" + std::to_string(index) + "\"") },
+	_asteroid_gauge{ &Metrics().gauge("server_asteroids", "Asteroids alive across the worker's matches", "worker=\"" + std::to_string(index) + "\"") },
+	_sent_traffic{ Metrics(), "sent" }
+{
+	_incoming.bytes.reserve(MAX_INBOX_BYTES);
+	_draining.bytes.reserve(MAX_INBOX_BYTES);
+}
+
+MatchWorker::~MatchWorker()
+{
+	stop();
+}
+
+void MatchWorker::start()
+{
+	_thread = std::thread(&MatchWorker::run, this);
+}
+
+void MatchWorker::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{ _inbox_mutex };
+		_stay = false;
+	}
+	_wake.notify_one();
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+/*
+* brief: take ownership of a full match
+* param: match
+*/
+void MatchWorker::adopt(std::unique_ptr<Match> match)
+{
+	{
+		std::lock_guard<std::mutex> lock{ _inbox_mutex };
+		_incoming.adopted.push_back(std::move(match));
+	}
+	_match_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+* brief: queue one datagram for a match this worker owns
+* param: match
+* param: player_num
+* param: data
+* param: size
+*/
+void MatchWorker::post(Match* match, uint16_t player_num, const char* data, size_t size)
+{
+	std::lock_guard<std::mutex> lock{ _inbox_mutex };
+	if (_incoming.bytes.size() + size > MAX_INBOX_BYTES)
+	{
+		// The worker has fallen behind; newer SEND_PLAYERS will replace this one.
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	size_t offset = _incoming.bytes.size();
+	_incoming.bytes.insert(_incoming.bytes.end(), data, data + size);
+	_incoming.entries.push_back({ match, player_num, offset, size });
+}
+
+/*
+* brief: queue a seat's departure for a match this worker owns
+* param: match
+* param: player_num
+*/
+void MatchWorker::disconnect(Match* match, uint16_t player_num)
+{
+	std::lock_guard<std::mutex> lock{ _inbox_mutex };
+	_incoming.departures.push_back({ match, player_num });
+}
+
+/*
+* brief: sleep until the next tick, apply the inbox, tick every match
+*/
+void MatchWorker::run()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{ _inbox_mutex };
+			_wake.wait_for(lock, std::chrono::milliseconds(_scheduler.timeout_ms()), [&]() { return !_stay; });
+			if (!_stay)
+			{
+				break;
+			}
+		}
+
+		int steps = _scheduler.begin();
+		if (steps == 0)
+		{
+			continue;
+		}
+		TickScheduler::clock::time_point tick_start = TickScheduler::clock::now();
+
+		// Swap the buffers so the I/O thread can keep posting while we apply.
+		{
+			std::lock_guard<std::mutex> lock{ _inbox_mutex };
+			std::swap(_incoming.bytes, _draining.bytes);
+			std::swap(_incoming.entries, _draining.entries);
+			std::swap(_incoming.departures, _draining.departures);
+			std::swap(_incoming.adopted, _draining.adopted);
+		}
+
+		for (std::unique_ptr<Match>& match : _draining.adopted)
+		{
+			_matches.push_back(std::move(match));
+		}
+		for (const Inbox::Entry& entry : _draining.entries)
+		{
+			entry.match->receive(entry.player_num, _draining.bytes.data() + entry.offset, entry.size);
+		}
+		// After the datagrams, which were all posted before the session went
+		for (const Inbox::Departure& departure : _draining.departures)
+		{
+			departure.match->leave(departure.player_num);
+		}
+		_draining.clear();
+		retire_abandoned();
+
+		for (std::unique_ptr<Match>& match : _matches)
+		{
+			match->tick(steps, _scheduler.tick_seconds());
+		}
+
+		auto tick_us = std::chrono::duration_cast<std::chrono::microseconds>(TickScheduler::clock::now() - tick_start).count();
+		_tick_duration->record(static_cast<uint64_t>(tick_us));
+		_scheduler.end();
+
+		// Release the rest of the tick's datagrams at even points across the
+		// interval instead of in one burst at the tick boundary.
+		for (int slot = 1; slot < PACING_SLOTS; ++slot)
+		{
+			{
+				std::unique_lock<std::mutex> lock{ _inbox_mutex };
+				_wake.wait_until(lock, tick_start + _scheduler.interval() * slot / PACING_SLOTS, [&]() { return !_stay; });
+			}
+			for (std::unique_ptr<Match>& match : _matches)
+			{
+				match->send_paced(slot);
+			}
+		}
+
+		publish_metrics();
+		report();
+	}
+}
+
+/*
+* brief: destroy the matches whose seats have all left. The I/O thread has
+*        dropped every session pointing at them, so nothing posts to them again.
+*/
+void MatchWorker::retire_abandoned()
+{
+	auto retired = std::remove_if(_matches.begin(), _matches.end(),
+		[](const std::unique_ptr<Match>& match) { return match->abandoned(); });
+	for (auto it = retired; it != _matches.end(); ++it)
+	{
+		_retired.add(**it);
+		{
+			std::lock_guard<std::mutex> lock{ stdout_mutex };
+			std::cout << "Match " << (*it)->id() << " abandoned, retired from worker " << _index << '\n';
+		}
+		_match_count.fetch_sub(1, std::memory_order_relaxed);
+	}
+	_matches.erase(retired, _matches.end());
+}
+
+/*
+* brief: fold this tick's sends and match state into the shared registry
+*/
+void MatchWorker::publish_metrics()
+{
+	size_t asteroids = 0;
+	for (std::unique_ptr<Match>& match : _matches)
+	{
+		_sent_traffic.publish(match->sent_tally());
+		asteroids += match->asteroid_count();
+	}
+	_match_gauge->set(static_cast<double>(_matches.size()));
+	_asteroid_gauge->set(static_cast<double>(asteroids));
+}
+
+/*
+* brief: print this worker's tick, fan-out and snapshot summary
+*/
+void MatchWorker::report()
+{
+	std::ostringstream line;
+	line << "Worker " << _index << " matches=" << _matches.size() << ' ';
+	if (!_scheduler.report(line))
+	{
+		return;
+	}
+
+	//the per-tick counters only mean something for matches still being ticked
+	MatchTotals totals = _retired;
+	uint64_t saved_per_tick = 0;
+	for (const std::unique_ptr<Match>& match : _matches)
+	{
+		totals.add(*match);
+		saved_per_tick += match->fanout().tick_syscalls_saved();
+	}
+
+	std::lock_guard<std::mutex> lock{ stdout_mutex };
+	std::cout << line.str();
+	std::cout << "Worker " << _index << " Fanout datagrams=" << totals.datagrams
+		<< " syscalls=" << totals.syscalls
+		<< " saved=" << totals.saved
+		<< " saved/tick=" << saved_per_tick
+		<< " failed=" << totals.failed
+		<< " inbox dropped=" << dropped_datagrams()
+		<< std::endl;
+	std::cout << "Worker " << _index << " Snapshot bytes sent=" << totals.sent
+		<< " raw=" << totals.raw
+		<< " over budget=" << totals.deferred
+		<< std::endl;
+	std::cout << "Worker " << _index << " Fragmented messages=" << totals.fragmented
+		<< " fragments=" << totals.fragments
+		<< " oversized=" << totals.oversized
+		<< std::endl;
+}
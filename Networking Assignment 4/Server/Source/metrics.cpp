@@ -0,0 +1,353 @@
+/******************************************************************************/
+/*!
+\file		metrics.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Metrics registry and its Prometheus text rendering
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	/*
+	* brief: label value for a tally slot, or nullptr for CMDID values that
+	*        are not defined and are counted as OTHER
+	*/
+	const char* CommandName(size_t slot)
+	{
+		switch (slot)
+		{
+		case UNKNOWN: return "UNKNOWN";
+		case REQ_QUIT: return "REQ_QUIT";
+		case REQ_LISTUSERS: return "REQ_LISTUSERS";
+		case RSP_LISTUSERS: return "RSP_LISTUSERS";
+		case SEND_PLAYERS: return "SEND_PLAYERS";
+		case RECEIVE_PLAYERS: return "RECEIVE_PLAYERS";
+		case SEND_ASTEROIDS: return "SEND_ASTEROIDS";
+		case RECEIVE_ASTEROIDS: return "RECEIVE_ASTEROIDS";
+		case SEND_BULLETS: return "SEND_BULLETS";
+		case RECEIVE_BULLETS: return "RECEIVE_BULLETS";
+		case SNAPSHOT_DELTA: return "SNAPSHOT_DELTA";
+		case FRAGMENT: return "FRAGMENT";
+		case ASTEROID_HIT: return "ASTEROID_HIT";
+		case CMD_TEST: return "CMD_TEST";
+		case ECHO_ERROR: return "ECHO_ERROR";
+		case CommandTally::HANDSHAKE: return "HANDSHAKE";
+		case CommandTally::OTHER: return "OTHER";
+		default: return nullptr;
+		}
+	}
+
+	/*
+	* brief: "{labels}", "{labels,extra}" or "{extra}", or nothing at all
+	*/
+	void WriteLabels(std::ostream& os, const std::string& labels, const std::string& extra = "")
+	{
+		if (labels.empty() && extra.empty())
+		{
+			return;
+		}
+		os << '{' << labels;
+		if (!labels.empty() && !extra.empty())
+		{
+			os << ',';
+		}
+		os << extra << '}';
+	}
+}
+
+Histogram::Histogram(uint64_t max_value, double scale) :
+	_scale{ scale },
+	_max_value{ std::max<uint64_t>(max_value, 1) },
+	_bucket_count{ bucket_index(_max_value) + 1 },
+	_buckets{ std::make_unique<std::atomic<uint64_t>[]>(_bucket_count) }
+{
+}
+
+/*
+* brief: values below SUB_BUCKETS get a bucket each; above that, every power
+*        of two is split into SUB_BUCKETS equal buckets
+* param: value
+*/
+size_t Histogram::bucket_index(uint64_t value)
+{
+	if (value < SUB_BUCKETS)
+	{
+		return static_cast<size_t>(value);
+	}
+	int shift = 63 - std::countl_zero(value) - SUB_BUCKET_BITS;
+	return static_cast<size_t>(shift) * SUB_BUCKETS + static_cast<size_t>(value >> shift);
+}
+
+uint64_t Histogram::bucket_upper(size_t index)
+{
+	if (index < SUB_BUCKETS)
+	{
+		return index;
+	}
+	size_t shift = index / SUB_BUCKETS - 1;
+	uint64_t mantissa = index - shift * SUB_BUCKETS;
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value)
+{
+	_buckets[bucket_index(std::min(value, _max_value))].fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(value, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*
+* brief: the series for name and labels, added empty if new. Call with _mutex held.
+*/
+MetricsRegistry::Series& MetricsRegistry::find_or_add(const std::string& name, const std::string& help, Type type, const std::string& labels)
+{
+	auto family = std::find_if(_families.begin(), _families.end(),
+		[&](const std::unique_ptr<Family>& candidate) { return candidate->name == name; });
+	if (family == _families.end())
+	{
+		_families.push_back(std::make_unique<Family>(Family{ name, help, type, {} }));
+		family = _families.end() - 1;
+	}
+
+	// The metrics themselves sit behind unique_ptrs, so growing the list moves
+	// nothing a caller holds.
+	std::vector<Series>& series = (*family)->series;
+	auto existing = std::find_if(series.begin(), series.end(),
+		[&](const Series& candidate) { return candidate.labels == labels; });
+	if (existing != series.end())
+	{
+		return *existing;
+	}
+	series.push_back(Series{ labels, nullptr, nullptr, nullptr });
+	return series.back();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+	Series& series = find_or_add(name, help, Type::COUNTER, labels);
+	if (!series.counter)
+	{
+		series.counter = std::make_unique<Counter>();
+	}
+	return *series.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+	Series& series = find_or_add(name, help, Type::GAUGE, labels);
+	if (!series.gauge)
+	{
+		series.gauge = std::make_unique<Gauge>();
+	}
+	return *series.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+	uint64_t max_value, double scale)
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+	Series& series = find_or_add(name, help, Type::HISTOGRAM, labels);
+	if (!series.histogram)
+	{
+		series.histogram = std::make_unique<Histogram>(max_value, scale);
+	}
+	return *series.histogram;
+}
+
+/*
+* brief: forget one series, e.g. a session's once it has left
+* param: name
+* param: labels
+*/
+void MetricsRegistry::remove(const std::string& name, const std::string& labels)
+{
+	std::lock_guard<std::mutex> lock{ _mutex };
+	auto family = std::find_if(_families.begin(), _families.end(),
+		[&](const std::unique_ptr<Family>& candidate) { return candidate->name == name; });
+	if (family == _families.end())
+	{
+		return;
+	}
+
+	std::vector<Series>& series = (*family)->series;
+	series.erase(std::remove_if(series.begin(), series.end(),
+		[&](const Series& candidate) { return candidate.labels == labels; }), series.end());
+}
+
+/*
+* brief: render every metric in the Prometheus text exposition format
+* param: os
+*/
+void MetricsRegistry::write_prometheus(std::ostream& os) const
+{
+	std::ostringstream text;
+	text << std::setprecision(10);
+
+	std::lock_guard<std::mutex> lock{ _mutex };
+	for (const std::unique_ptr<Family>& family : _families)
+	{
+		text << "# HELP " << family->name << ' ' << family->help << '\n';
+		text << "# TYPE " << family->name << ' '
+			<< (family->type == Type::COUNTER ? "counter" : family->type == Type::GAUGE ? "gauge" : "histogram") << '\n';
+
+		for (const Series& series : family->series)
+		{
+			if (series.counter)
+			{
+				text << family->name;
+				WriteLabels(text, series.labels);
+				text << ' ' << series.counter->get() << '\n';
+			}
+			else if (series.gauge)
+			{
+				text << family->name;
+				WriteLabels(text, series.labels);
+				text << ' ' << series.gauge->get() << '\n';
+			}
+			else if (series.histogram)
+			{
+				// Buckets are read one at a time while other threads record, so
+				// the total is taken from what was read to keep +Inf and _count
+				// consistent with the buckets listed.
+				const Histogram& histogram = *series.histogram;
+				uint64_t cumulative = 0;
+				for (size_t i = 0; i < histogram.bucket_count(); ++i)
+				{
+					uint64_t hits = histogram.bucket(i);
+					if (hits == 0)
+					{
+						continue;
+					}
+					cumulative += hits;
+
+					std::ostringstream le;
+					le << std::setprecision(10) << "le=\"" << static_cast<double>(Histogram::bucket_upper(i)) * histogram.scale() << '"';
+					text << family->name << "_bucket";
+					WriteLabels(text, series.labels, le.str());
+					text << ' ' << cumulative << '\n';
+				}
+				text << family->name << "_bucket";
+				WriteLabels(text, series.labels, "le=\"+Inf\"");
+				text << ' ' << cumulative << '\n';
+
+				text << family->name << "_sum";
+				WriteLabels(text, series.labels);
+				text << ' ' << static_cast<double>(histogram.sum()) * histogram.scale() << '\n';
+
+				text << family->name << "_count";
+				WriteLabels(text, series.labels);
+				text << ' ' << cumulative << '\n';
+			}
+		}
+	}
+
+	os << text.str();
+}
+
+bool MetricsRegistry::write_file(const std::string& path) const
+{
+	std::string temporary = path + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+		write_prometheus(file);
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	return !error;
+}
+
+MetricsRegistry& Metrics()
+{
+	static MetricsRegistry registry;
+	return registry;
+}
+
+void CommandTally::add(const char* data, size_t size)
+{
+	size_t slot = OTHER;
+	CMDID id;
+	if (size >= sizeof(id))
+	{
+		memcpy(&id, data, sizeof(id));
+		uint32_t value = static_cast<uint32_t>(id);
+		if (value < HANDSHAKE)
+		{
+			slot = value;
+		}
+	}
+	++datagrams[slot];
+	bytes[slot] += size;
+}
+
+void CommandTally::add_handshake(size_t size, uint64_t count)
+{
+	datagrams[HANDSHAKE] += count;
+	bytes[HANDSHAKE] += size * count;
+}
+
+CommandTraffic::CommandTraffic(MetricsRegistry& registry, const std::string& direction)
+{
+	std::string datagramName = "server_datagrams_" + direction + "_total";
+	std::string byteName = "server_bytes_" + direction + "_total";
+	std::string datagramHelp = "UDP datagrams " + direction + ", by the CMDID they start with";
+	std::string byteHelp = "UDP payload bytes " + direction + ", by the CMDID they start with";
+
+	// Register the named slots first so undefined values can share OTHER's counters
+	for (size_t slot = 0; slot < CommandTally::SLOTS; ++slot)
+	{
+		if (const char* name = CommandName(slot))
+		{
+			std::string labels = std::string("cmd=\"") + name + "\"";
+			_datagrams[slot] = &registry.counter(datagramName, datagramHelp, labels);
+			_bytes[slot] = &registry.counter(byteName, byteHelp, labels);
+		}
+	}
+	for (size_t slot = 0; slot < CommandTally::SLOTS; ++slot)
+	{
+		if (_datagrams[slot] == nullptr)
+		{
+			_datagrams[slot] = _datagrams[CommandTally::OTHER];
+			_bytes[slot] = _bytes[CommandTally::OTHER];
+		}
+	}
+}
+
+void CommandTraffic::publish(CommandTally& tally)
+{
+	for (size_t slot = 0; slot < CommandTally::SLOTS; ++slot)
+	{
+		if (tally.datagrams[slot] != 0)
+		{
+			_datagrams[slot]->add(tally.datagrams[slot]);
+			_bytes[slot]->add(tally.bytes[slot]);
+		}
+	}
+	tally = CommandTally{};
+}
@@ -0,0 +1,220 @@
+/******************************************************************************/
+/*!
+\file		metricsendpoint.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Loopback HTTP endpoint serving the metrics registry
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "metricsendpoint.h"
+
+#include <iostream>
+#include <sstream>
+
+MetricsEndpoint::MetricsEndpoint(EventLoop& event_loop, const MetricsRegistry& registry) :
+	_event_loop{ event_loop },
+	_registry{ registry }
+{
+}
+
+MetricsEndpoint::~MetricsEndpoint()
+{
+	while (!_connections.empty())
+	{
+		close(_connections.begin()->first);
+	}
+	if (_listener != INVALID_SOCKET)
+	{
+		_event_loop.remove(_listener);
+		closesocket(_listener);
+	}
+}
+
+/*
+* brief: open the listener on the loopback interface
+* param: port
+*/
+bool MetricsEndpoint::listen(uint16_t port)
+{
+	_listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (_listener == INVALID_SOCKET)
+	{
+		std::cerr << "metrics socket() failed." << std::endl;
+		return false;
+	}
+
+	int reuse = 1;
+	setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+	sockaddr_in local_endpoint{};
+	local_endpoint.sin_family = AF_INET;
+	local_endpoint.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	local_endpoint.sin_port = htons(port);
+
+	if (bind(_listener, (SOCKADDR*)&local_endpoint, sizeof(local_endpoint)) != NO_ERROR ||
+		::listen(_listener, SOMAXCONN) != NO_ERROR ||
+		!set_nonblocking(_listener, true) ||
+		!_event_loop.add(_listener))
+	{
+		std::cerr << "metrics listener setup failed with error: " << WSAGetLastError() << std::endl;
+		closesocket(_listener);
+		_listener = INVALID_SOCKET;
+		return false;
+	}
+	return true;
+}
+
+bool MetricsEndpoint::owns(SOCKET socket) const
+{
+	return socket == _listener || _connections.count(socket) != 0;
+}
+
+void MetricsEndpoint::on_ready(SOCKET socket)
+{
+	if (socket == _listener)
+	{
+		accept_all();
+		return;
+	}
+
+	auto connection = _connections.find(socket);
+	if (connection == _connections.end())
+	{
+		return;
+	}
+
+	// Once the reply is built the socket is only watched for writability
+	bool keep = connection->second.response.empty()
+		? read(socket, connection->second)
+		: flush(socket, connection->second);
+	if (!keep)
+	{
+		close(socket);
+	}
+}
+
+void MetricsEndpoint::accept_all()
+{
+	while (true)
+	{
+		SOCKET client = accept(_listener, nullptr, nullptr);
+		if (client == INVALID_SOCKET)
+		{
+			int errorCode = WSAGetLastError();
+			if (!would_block(errorCode))
+			{
+				std::cerr << "metrics accept failed with error: " << errorCode << '\n';
+			}
+			return;
+		}
+
+		if (!set_nonblocking(client, true) || !_event_loop.add(client))
+		{
+			closesocket(client);
+			continue;
+		}
+		_connections.emplace(client, Connection{});
+	}
+}
+
+/*
+* brief: collect the request header and answer once it is complete
+* param: socket
+* param: connection
+* return: false once the connection is done with
+*/
+bool MetricsEndpoint::read(SOCKET socket, Connection& connection)
+{
+	std::string& request = connection.request;
+	char buffer[1024];
+	while (true)
+	{
+		int bytesReceived = recv(socket, buffer, sizeof(buffer), 0);
+		if (bytesReceived == SOCKET_ERROR)
+		{
+			return would_block(WSAGetLastError());
+		}
+		if (bytesReceived == 0)
+		{
+			return false;
+		}
+		request.append(buffer, static_cast<size_t>(bytesReceived));
+
+		if (request.find("\r\n\r\n") != std::string::npos)
+		{
+			return respond(socket, connection);
+		}
+		if (request.size() > MAX_REQUEST_SIZE)
+		{
+			return false;
+		}
+	}
+}
+
+/*
+* brief: render the registry into the connection's reply and start sending it
+* param: socket
+* param: connection
+* return: false once the connection is done with
+*/
+bool MetricsEndpoint::respond(SOCKET socket, Connection& connection)
+{
+	std::ostringstream body;
+	_registry.write_prometheus(body);
+	std::string text = body.str();
+
+	connection.request.clear();
+	connection.response = "HTTP/1.1 200 OK\r\n"
+		"Content-Type: text/plain; version=0.0.4\r\n"
+		"Connection: close\r\n"
+		"Content-Length: " + std::to_string(text.size()) + "\r\n\r\n" + text;
+	connection.sent = 0;
+	return flush(socket, connection);
+}
+
+/*
+* brief: send as much of the reply as the kernel takes. If some is left, the
+*        socket is watched for writability and this runs again when it is.
+* param: socket
+* param: connection
+* return: false once the reply is all out or the scraper has gone
+*/
+bool MetricsEndpoint::flush(SOCKET socket, Connection& connection)
+{
+	const std::string& response = connection.response;
+	while (connection.sent < response.size())
+	{
+		int bytesSent = send(socket, response.data() + connection.sent,
+			static_cast<int>(response.size() - connection.sent), MSG_NOSIGNAL);
+		if (bytesSent == SOCKET_ERROR)
+		{
+			int errorCode = WSAGetLastError();
+			if (would_block(errorCode))
+			{
+				return _event_loop.watch_writes(socket, true);
+			}
+			std::cerr << "metrics scrape of " << response.size() << " bytes dropped after "
+				<< connection.sent << " with error: " << errorCode << '\n';
+			return false;
+		}
+		connection.sent += static_cast<size_t>(bytesSent);
+	}
+	return false;
+}
+
+void MetricsEndpoint::close(SOCKET socket)
+{
+	if (_connections.erase(socket) == 0)
+	{
+		return;
+	}
+	_event_loop.remove(socket);
+	shutdown(socket, SD_BOTH);
+	closesocket(socket);
+}
@@ -0,0 +1,242 @@
+/******************************************************************************/
+/*!
+\file		netplatform.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Portable socket layer and readiness loop for the server
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "netplatform.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <termios.h>
+#endif
+
+/*
+* brief: initialise the socket library
+*/
+bool net_startup()
+{
+#ifdef _WIN32
+	WSADATA wsaData{};
+	return WSAStartup(MAKEWORD(2, 2), &wsaData) == NO_ERROR;
+#else
+	return true;
+#endif
+}
+
+/*
+* brief: release the socket library
+*/
+void net_cleanup()
+{
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+/*
+* brief: switch a socket between blocking and non-blocking mode
+* param: socket
+* param: enable
+*/
+bool set_nonblocking(SOCKET socket, bool enable)
+{
+#ifdef _WIN32
+	u_long mode = enable ? 1 : 0; // 1 for non-blocking mode, 0 for blocking mode
+	return ioctlsocket(socket, FIONBIO, &mode) == NO_ERROR;
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	if (flags == -1)
+	{
+		return false;
+	}
+	flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+	return fcntl(socket, F_SETFL, flags) == 0;
+#endif
+}
+
+/*
+* brief: true if the error code means "try again later"
+* param: error
+*/
+bool would_block(int error)
+{
+#ifdef _WIN32
+	return error == WSAEWOULDBLOCK;
+#else
+	return error == EWOULDBLOCK || error == EAGAIN || error == EINTR;
+#endif
+}
+
+/*
+* brief: stop the console from echoing typed input
+*/
+void disable_console_echo()
+{
+#ifdef _WIN32
+	HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
+	DWORD mode;
+	GetConsoleMode(hInput, &mode);
+	SetConsoleMode(hInput, mode & (~ENABLE_ECHO_INPUT) & (~ENABLE_LINE_INPUT));
+#else
+	termios mode{};
+	if (tcgetattr(STDIN_FILENO, &mode) == 0)
+	{
+		mode.c_lflag &= ~(ECHO | ICANON);
+		tcsetattr(STDIN_FILENO, TCSANOW, &mode);
+	}
+#endif
+}
+
+#ifdef __linux__
+
+// Upper bound on readiness events returned by one epoll_wait.
+constexpr size_t MAX_EVENTS = 16;
+
+EventLoop::EventLoop() :
+	_epoll{ epoll_create1(EPOLL_CLOEXEC) },
+	_events(MAX_EVENTS)
+{
+}
+
+EventLoop::~EventLoop()
+{
+	if (_epoll != -1)
+	{
+		close(_epoll);
+	}
+}
+
+/*
+* brief: register a socket for read readiness
+* param: socket
+*/
+bool EventLoop::add(SOCKET socket)
+{
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = socket;
+	return epoll_ctl(_epoll, EPOLL_CTL_ADD, socket, &event) == 0;
+}
+
+/*
+* brief: unregister a socket
+* param: socket
+*/
+void EventLoop::remove(SOCKET socket)
+{
+	epoll_ctl(_epoll, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+/*
+* brief: switch a socket between read and write readiness
+* param: socket
+* param: enable
+*/
+bool EventLoop::watch_writes(SOCKET socket, bool enable)
+{
+	epoll_event event{};
+	event.events = enable ? EPOLLOUT : EPOLLIN;
+	event.data.fd = socket;
+	return epoll_ctl(_epoll, EPOLL_CTL_MOD, socket, &event) == 0;
+}
+
+/*
+* brief: wait for readiness or timeout
+* param: timeout_ms
+*/
+int EventLoop::wait(int timeout_ms)
+{
+	int count = epoll_wait(_epoll, _events.data(), static_cast<int>(_events.size()), timeout_ms);
+	if (count < 0 && errno == EINTR)
+	{
+		return 0;
+	}
+	return count;
+}
+
+SOCKET EventLoop::ready(int i) const
+{
+	return _events[i].data.fd;
+}
+
+#else
+
+EventLoop::EventLoop() = default;
+EventLoop::~EventLoop() = default;
+
+bool EventLoop::add(SOCKET socket)
+{
+	pollfd fd{};
+	fd.fd = socket;
+	fd.events = POLLIN;
+	_fds.push_back(fd);
+	return true;
+}
+
+void EventLoop::remove(SOCKET socket)
+{
+	_fds.erase(std::remove_if(_fds.begin(), _fds.end(),
+		[socket](const pollfd& fd) { return fd.fd == socket; }), _fds.end());
+}
+
+bool EventLoop::watch_writes(SOCKET socket, bool enable)
+{
+	for (pollfd& fd : _fds)
+	{
+		if (fd.fd == socket)
+		{
+			fd.events = enable ? POLLOUT : POLLIN;
+			return true;
+		}
+	}
+	return false;
+}
+
+int EventLoop::wait(int timeout_ms)
+{
+	_ready.clear();
+	if (_fds.empty())
+	{
+		return 0;
+	}
+
+#ifdef _WIN32
+	int count = WSAPoll(_fds.data(), static_cast<ULONG>(_fds.size()), timeout_ms);
+#else
+	int count = poll(_fds.data(), static_cast<nfds_t>(_fds.size()), timeout_ms);
+	if (count < 0 && errno == EINTR)
+	{
+		return 0;
+	}
+#endif
+	if (count <= 0)
+	{
+		return count;
+	}
+
+	for (const pollfd& fd : _fds)
+	{
+		if (fd.revents & (POLLIN | POLLOUT | POLLERR | POLLHUP))
+		{
+			_ready.push_back(fd.fd);
+		}
+	}
+	return static_cast<int>(_ready.size());
+}
+
+SOCKET EventLoop::ready(int i) const
+{
+	return _ready[i];
+}
+
+#endif
@@ -0,0 +1,92 @@
+/******************************************************************************/
+/*!
+\file		rosterimage.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Incrementally maintained RSP_LISTUSERS reply
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "rosterimage.h"
+
+#include <cstring>
+
+#include "server.h"
+
+RosterImage::RosterImage() :
+	_wire(HEADER_SIZE)
+{
+	_wire[sizeof(uint32_t)] = static_cast<char>(RSP_LISTUSERS);
+	publish();
+}
+
+/*
+* brief: append a user to the reply
+* param: key
+*/
+void RosterImage::add(const EndpointKey& key)
+{
+	if (!key.is_ipv4() || _offsets.find(key) != nullptr)
+	{
+		return;
+	}
+
+	uint32_t ipAddr = key.ipv4_address();
+	uint16_t portNum = key.ipv4_port();
+
+	size_t offset = _wire.size();
+	_wire.resize(offset + ENTRY_SIZE);
+	memcpy(&_wire[offset], &ipAddr, sizeof(ipAddr));
+	memcpy(&_wire[offset + sizeof(ipAddr)], &portNum, sizeof(portNum));
+
+	_offsets.insert(key, offset, SessionTable<size_t>::Clock::time_point{});
+	publish();
+}
+
+/*
+* brief: drop a user, moving the last entry into its place
+* param: key
+*/
+void RosterImage::remove(const EndpointKey& key)
+{
+	size_t* found = _offsets.find(key);
+	if (found == nullptr)
+	{
+		return;
+	}
+
+	size_t offset = *found;
+	_offsets.erase(key);
+
+	size_t last = _wire.size() - ENTRY_SIZE;
+	if (offset != last)
+	{
+		memcpy(&_wire[offset], &_wire[last], ENTRY_SIZE);
+
+		uint32_t ipAddr;
+		uint16_t portNum;
+		memcpy(&ipAddr, &_wire[offset], sizeof(ipAddr));
+		memcpy(&portNum, &_wire[offset + sizeof(ipAddr)], sizeof(portNum));
+		*_offsets.find(MakeEndpointKey(ipAddr, portNum)) = offset;
+	}
+	_wire.resize(last);
+	publish();
+}
+
+/*
+* brief: patch the length and count, then swap in an immutable copy
+*/
+void RosterImage::publish()
+{
+	uint32_t length = htonl(static_cast<uint32_t>(_wire.size() - sizeof(uint32_t)));
+	uint16_t numUsers = htons(static_cast<uint16_t>((_wire.size() - HEADER_SIZE) / ENTRY_SIZE));
+	memcpy(&_wire[0], &length, sizeof(length));
+	memcpy(&_wire[sizeof(uint32_t) + sizeof(uint8_t)], &numUsers, sizeof(numUsers));
+
+	_published.store(std::make_shared<const std::vector<char>>(_wire), std::memory_order_release);
+}
@@ -12,311 +12,314 @@ prior written consent of DigiPen Institute of Technology is prohibited.
  */
  /******************************************************************************/
 
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-
-#include "Windows.h"
-#include "ws2tcpip.h"
-#include <iphlpapi.h>
-
-#pragma comment(lib, "IPHLPAPI.lib")
-#pragma comment(lib, "ws2_32.lib")
-
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>	
 #include <string>
 #include <thread>
 #include <vector>
 
-#include <map>
+#include <memory>
 #include <filesystem>
 #include <fstream>
 
+#include "controlchannel.h"
+#include "match.h"
+#include "matchworker.h"
+#include "metrics.h"
+#include "metricsendpoint.h"
+#include "netplatform.h"
+#include "sessiontable.h"
 #include "taskqueue.h"
 #include "server.h"
+#include "wireformat.h"
 
 //=====================================================================================
-//FOR AESTEROIDS
-const int			ASTEROID_SCORE = 300;			// score per asteroid destroyed
-const float			ASTEROID_SIZE = 70.0f;		// asteroid size
-const float			ASTEROID_SPEED = 100.0f;		// maximum asteroid speed
-const float			ASTEROID_TIME = 2.0f;			// 2 second spawn time for asteroids
-const int			ASTEROID_MAX = 50;			// 2 second spawn time for asteroids
-
-const int			WINDOW_WIDTH = 800;
-const int			WINDOW_HEIGHT = 600;
-
-struct ASTEROID
-{
-	int		_id;
-	bool	_active;
-
-	float	_size;
-	Vec2	_pos;
-	Vec2	_vel;
-	float	_rot;
-
-	ASTEROID() = default;
-	ASTEROID(int id, bool active, float size, Vec2 pos, Vec2 vel, float rot)
-		: _id(id), _active(active), _size(size), _pos(pos), _vel(vel), _rot(rot) {}
-};
 
-int						asteroid_id{};
-std::vector<ASTEROID>	asteroids_list;
-static float			asteroid_timer = 0.f;
+const int			SERVER_TICK_RATE = 60;		// default ticks (and snapshots) per second
+const int			MAX_CATCH_UP_TICKS = 3;		// most simulation steps run after an overrun
+const int			SESSION_IDLE_SECONDS = 10;	// silence after which a playing session is dropped
+const int			SESSION_SWEEP_MS = 1000;	// how often idle sessions are looked for
+const int			METRICS_DUMP_SECONDS = 10;	// how often --metrics-file is rewritten
 
-
-#include <chrono>
-
-class DeltaTime {
-public:
-	DeltaTime() : lastFrameTime(std::chrono::steady_clock::now()) {}
-
-	float GetDeltaTime() {
-		auto currentTime = std::chrono::steady_clock::now();
-		std::chrono::duration<float> deltaTime = currentTime - lastFrameTime;
-		lastFrameTime = currentTime;
-		return deltaTime.count();
-	}
-private:
-	std::chrono::steady_clock::time_point lastFrameTime;
-};
-
-DeltaTime delta_time;
-
-void spawnAsteroid(unsigned int count);
+// The only datagram that seats an unknown address
+const char			HANDSHAKE_MESSAGE[] = "Hello, server!";
+const size_t		HANDSHAKE_LENGTH = sizeof(HANDSHAKE_MESSAGE) - 1;
 
 //=====================================================================================
 
-std::map<std::string, SOCKET> client_port;
-
 SOCKET udp_listener_socket;
 std::mutex udp_mutex;
 
-std::vector<ClientInfo> clients;
+// Where a client's datagrams go once its handshake has been answered.
+// worker stays null while the match is still filling in the lobby.
+struct Session
+{
+	Match* match;
+	MatchWorker* worker;
+	uint16_t player_num;
+};
+
+// Owned by the I/O thread; workers never see it
+SessionTable<Session> sessions;
+std::vector<std::unique_ptr<MatchWorker>> workers;
 
-uint16_t numConnectedPlayers = 0;
-const int MAX_PLAYERS = 4;
+// The match currently filling, and the sessions seated in it
+std::unique_ptr<Match> lobby;
+std::vector<EndpointKey> lobby_sessions;
+uint32_t next_match_id = 1;
+uint32_t client_budget = CLIENT_SEND_BUDGET;
+int tick_rate = SERVER_TICK_RATE;
 
-std::vector<Player> players(MAX_PLAYERS);
-std::vector<std::vector<Bullet>> bullets(MAX_PLAYERS);
+// Allocated once and reused by every receive
+std::vector<char> receive_buffer(RECEIVE_BUFFER_SIZE);
 
-void SendToAllClients(const char* message)
+// Counted per datagram, published to the registry once per drain
+CommandTally received_tally;
+CommandTraffic received_traffic(Metrics(), "received");
+// Handshake answers repeated by this thread; matches count their own sends
+CommandTally sent_tally;
+CommandTraffic sent_traffic(Metrics(), "sent");
+Gauge& session_gauge = Metrics().gauge("server_sessions", "Client endpoints with a session, in the lobby or playing");
+
+/*
+* brief: the worker with the fewest matches
+*/
+MatchWorker& LeastLoadedWorker()
 {
-	for (const auto& client : clients)
+	MatchWorker* best = workers.front().get();
+	for (const auto& worker : workers)
 	{
-		if (client.isConnected)
+		if (worker->match_count() < best->match_count())
 		{
-			sendto(udp_listener_socket, message, strlen(message), 0, (SOCKADDR*)&client.address, sizeof(client.address));
+			best = worker.get();
 		}
 	}
+	return *best;
+}
+
+/*
+* brief: true if the datagram is the client's handshake text
+* param: data
+* param: size
+*/
+bool IsHandshake(const char* data, size_t size)
+{
+	return size == HANDSHAKE_LENGTH && memcmp(data, HANDSHAKE_MESSAGE, HANDSHAKE_LENGTH) == 0;
 }
 
-void SendFloatToAllClients(float num)
+/*
+* brief: answer a handshake from an address that is already seated, whose
+*        first answer was lost: its seat number again, then the start signal
+*        if its match is already running
+* param: clientAddr
+* param: session
+*/
+void RepeatHandshakeAnswer(const sockaddr_in& clientAddr, const Session& session)
 {
-	// Convert the float to a byte array
-	char buffer[sizeof(float)];
-	memcpy(buffer, &num, sizeof(float));
+	std::string seat = std::to_string(session.player_num - 1);
+	sendto(udp_listener_socket, seat.c_str(), static_cast<int>(seat.size()), 0, (const SOCKADDR*)&clientAddr, sizeof(clientAddr));
+	sent_tally.add_handshake(seat.size());
 
-	for (const auto& client : clients)
+	if (session.worker != nullptr)
 	{
-		if (client.isConnected)
-		{
-			sendto(udp_listener_socket, buffer, sizeof(buffer), 0, (SOCKADDR*)&client.address, sizeof(client.address));
-		}
+		std::string start = std::to_string(MAX_PLAYERS);
+		sendto(udp_listener_socket, start.c_str(), static_cast<int>(start.size()), 0, (const SOCKADDR*)&clientAddr, sizeof(clientAddr));
+		sent_tally.add_handshake(start.size());
 	}
 }
 
-void GetPosOfAllCLients()
+/*
+* brief: seat a new address in the lobby match; once it is full, start it and
+*        pin it to a worker
+* param: clientAddr
+* param: key
+* param: message
+* param: now
+*/
+void HandleHandshake(const sockaddr_in& clientAddr, const EndpointKey& key, const char* message, SessionTable<Session>::Clock::time_point now)
 {
-	
-}
+	std::cout << "Received message from client: " << message << '\n';
 
-void SendPlayersPosToAllClients()
-{
-	//char recvBuffer[1024]; //TODO move to vec2
-	//std::vector<Vec2> receivedPositions(1);
-	CMDID receive_id;
-	std::vector<char> receive_buffer(4096);
-	for (const auto& client : clients)
+	if (!lobby)
 	{
-		if (client.isConnected)
-		{
-			int clientAddrSize = sizeof(client.address);
-			int bytesReceived = recvfrom(udp_listener_socket, reinterpret_cast<char*>(receive_buffer.data()), receive_buffer.size(), 0, (SOCKADDR*)&client.address, &clientAddrSize);
-			if (bytesReceived != SOCKET_ERROR)
-			{
-				memcpy(&receive_id, receive_buffer.data(), sizeof(receive_id));
-
-				switch (receive_id)
-				{
-				case SEND_PLAYERS: {
-					std::vector<Player> receivedPlayers(1);
-					size_t expected_data_size = bytesReceived - sizeof(receive_id) - sizeof(Player);
-					std::vector<Bullet> receivedBullets(expected_data_size/sizeof(Bullet));
-					memcpy(receivedPlayers.data(), receive_buffer.data() + sizeof(receive_id), sizeof(Player));
-					memcpy(receivedBullets.data(), receive_buffer.data() + sizeof(receive_id) + sizeof(Player), expected_data_size);
-
-					players[client.player_num - 1].player_id = receivedPlayers[0].player_id;
-					players[client.player_num - 1].position = receivedPlayers[0].position;
-					players[client.player_num - 1].velocity = receivedPlayers[0].velocity;
-					players[client.player_num - 1].direction = receivedPlayers[0].direction;
-					players[client.player_num - 1].num_bullets = receivedPlayers[0].num_bullets;
-					players[client.player_num - 1].shoot = receivedPlayers[0].shoot;
-
-					bullets[client.player_num - 1].resize(players[client.player_num - 1].num_bullets);
-					for (int i{}; i < players[client.player_num - 1].num_bullets; ++i)
-					{
-						bullets[client.player_num - 1][i] = receivedBullets[i];
-					}
-					break;
-				}
-
-				case SEND_ASTEROIDS: {
-					// Calculate how many asteroids are being received
-					size_t asteroidCount = (bytesReceived - sizeof(receive_id)) / sizeof(ASTEROID);
-					std::vector<ASTEROID> receivedAsteroids(asteroidCount);
-					memcpy(receivedAsteroids.data(), receive_buffer.data() + sizeof(receive_id), asteroidCount * sizeof(ASTEROID));
-
-					// Update or replace local asteroid list
-					asteroids_list.clear(); // or update in place if desired
-					for (const auto& asteroid : receivedAsteroids) {
-						asteroids_list.push_back(asteroid);
-					}
-
-					break;
-				}
-				default:
-					break;
-				}
-			}
-		}
+		lobby = std::make_unique<Match>(next_match_id++, udp_listener_socket, tick_rate, client_budget);
 	}
 
+	uint16_t player_num = lobby->join(clientAddr);
+	sessions.insert(key, { lobby.get(), nullptr, player_num }, now);
+	lobby_sessions.push_back(key);
 
-	CMDID id = SEND_PLAYERS;
-	// Calculate the total size needed for the combined data
-	size_t totalSize = sizeof(id) + MAX_PLAYERS * sizeof(Player); // Size of player data
-	for (const auto& playerBullets : bullets) {
-		totalSize += playerBullets.size() * sizeof(Bullet); // Size of bullet data for each player
+	if (!lobby->full())
+	{
+		return;
 	}
 
-	// Allocate memory for the combined data
-	std::vector<char> combinedData(totalSize);
-	char* bufferPtr = combinedData.data();
-
-	// Copy the command ID for player data into the buffer
-	memcpy(bufferPtr, &id, sizeof(id));
-	bufferPtr += sizeof(id);
+	lobby->start();
 
-	// Copy the player data into the buffer
-	memcpy(bufferPtr, players.data(), MAX_PLAYERS * sizeof(Player));
-	bufferPtr += MAX_PLAYERS * sizeof(Player);
-
-	// Copy the bullet data into the buffer
-	for (const auto& playerBullets : bullets) {
-		for (const auto& bullet : playerBullets) {
-			memcpy(bufferPtr, &bullet, sizeof(Bullet));
-			bufferPtr += sizeof(Bullet);
+	MatchWorker& worker = LeastLoadedWorker();
+	for (const EndpointKey& seated : lobby_sessions)
+	{
+		if (Session* session = sessions.touch(seated, now))
+		{
+			session->worker = &worker;
 		}
 	}
+	std::cout << "Match " << lobby->id() << " started on worker " << worker.index() << '\n';
 
-	// Send the combined byte array to all clients
-	for (const auto& client : clients) {
-		if (client.isConnected) {
-			sendto(udp_listener_socket, combinedData.data(), totalSize, 0, (SOCKADDR*)&client.address, sizeof(client.address));
-		}
-	}
+	lobby_sessions.clear();
+	worker.adopt(std::move(lobby));
 }
 
-void SendAsteroidDataToAllClients()
+/*
+* brief: drain every pending datagram. Known sessions are routed to the worker
+*        that owns their match; an unknown address is seated only if it sent
+*        the handshake, so strays from evicted clients are dropped. A seated
+*        address that repeats the handshake missed the answer and gets it again.
+*/
+void ReceiveDatagrams()
 {
-	if(asteroids_list.empty()) return;
+	// One clock read per wake-up is precise enough for idle tracking
+	auto now = SessionTable<Session>::Clock::now();
 
-	const int ID = 3;
+	while (true)
+	{
+		sockaddr_in clientAddr{};
+		socklen_t clientAddrSize = sizeof(clientAddr);
+		int bytesReceived = recvfrom(udp_listener_socket, receive_buffer.data(), static_cast<int>(receive_buffer.size() - 1), 0, (SOCKADDR*)&clientAddr, &clientAddrSize);
+		if (bytesReceived == SOCKET_ERROR)
+		{
+			int errorCode = WSAGetLastError();
+			if (!would_block(errorCode))
+			{
+				std::cerr << "recvfrom failed with error: " << errorCode << '\n';
+			}
+			break;
+		}
 
-	//Convert asteroid data to byte array
-	int data_size = asteroids_list.size() * sizeof(ASTEROID);
-	std::vector<char> buffer(data_size);
+		EndpointKey key = MakeEndpointKey(clientAddr);
+		Session* session = sessions.touch(key, now);
+		bool handshake = IsHandshake(receive_buffer.data(), static_cast<size_t>(bytesReceived));
+		if (session == nullptr)
+		{
+			if (!handshake)
+			{
+				received_tally.add(receive_buffer.data(), static_cast<size_t>(bytesReceived));
+				continue;
+			}
+			received_tally.add_handshake(static_cast<size_t>(bytesReceived));
+			receive_buffer[bytesReceived] = '\0';
+			HandleHandshake(clientAddr, key, receive_buffer.data(), now);
+			continue;
+		}
 
-	// Copy the ID into the buffer
-	memcpy(buffer.data(), &ID, sizeof(int));
+		if (handshake)
+		{
+			received_tally.add_handshake(static_cast<size_t>(bytesReceived));
+			RepeatHandshakeAnswer(clientAddr, *session);
+			continue;
+		}
 
-	// Copy asteroid data into the buffer
-	char* ptr = buffer.data() + sizeof(int);
-	for (const auto& asteroid : asteroids_list) {
-		memcpy(ptr, &asteroid, sizeof(ASTEROID));
-		ptr += sizeof(ASTEROID);
-	}
+		received_tally.add(receive_buffer.data(), static_cast<size_t>(bytesReceived));
 
-	// Send the byte array to all clients
-	for (const auto& client : clients)
-	{
-		if (client.isConnected)
+		// Still in the lobby; nothing to apply until the match starts.
+		if (session->worker == nullptr)
 		{
-			sendto(udp_listener_socket, buffer.data(), data_size, 0, (SOCKADDR*)&client.address, sizeof(client.address));
+			continue;
 		}
+
+		session->worker->post(session->match, session->player_num,
+			receive_buffer.data(), static_cast<size_t>(bytesReceived));
 	}
 
-	asteroids_list.clear();
+	received_traffic.publish(received_tally);
+	sent_traffic.publish(sent_tally);
+	session_gauge.set(static_cast<double>(sessions.size()));
 }
 
-void SendBulletDataToAllClients() {
-
+/*
+* brief: free the table slots of playing clients that have gone quiet and
+*        tell the owning worker to stop serving their seats.
+*        Lobby sessions are kept; they send nothing until their match starts.
+*/
+void EvictIdleSessions()
+{
+	auto cutoff = SessionTable<Session>::Clock::now() - std::chrono::seconds(SESSION_IDLE_SECONDS);
+	sessions.evict_idle(cutoff, [](const EndpointKey& key, const Session& session)
+		{
+			if (session.worker == nullptr)
+			{
+				return false;
+			}
+			std::cout << "Session " << EndpointKeyString(key) << " idle, evicted\n";
+			session.worker->disconnect(session.match, session.player_num);
+			return true;
+		});
+	session_gauge.set(static_cast<double>(sessions.size()));
 }
 
-void HandleClientConnection(const sockaddr_in& clientAddr)
+int main(int argc, char* argv[])
 {
-	// Find a client slot for the new client
-	for (auto& client : clients)
+	//std::cout << "Server UDP Port Number: ";
+	uint16_t udp_port{9000};
+
+	// Usage: Server [--tick-rate <hz>] [--workers <n>] [--client-budget <bytes/s>]
+	//               [--control-port <port>] [--metrics-port <port>]
+	//               [--metrics-file <path>] [--wire-report]
+	int worker_count{ static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+	int control_port{ udp_port + 1 };
+	int metrics_port{ 0 };
+	std::string metrics_file;
+	for (int i = 1; i < argc; ++i)
 	{
-		if (!client.isConnected)
+		std::string arg(argv[i]);
+		if (arg == "--tick-rate" && i + 1 < argc)
 		{
-			client.address = clientAddr;
-			client.isConnected = true;
-			break;
+			tick_rate = std::clamp(std::atoi(argv[++i]), 1, 1000);
 		}
-	}
-
-	// Check if all clients are connected
-	bool allClientsConnected = true;
-	for (const auto& client : clients)
-	{
-		if (!client.isConnected)
+		else if (arg == "--workers" && i + 1 < argc)
 		{
-			allClientsConnected = false;
-			break;
+			worker_count = std::clamp(std::atoi(argv[++i]), 1, 256);
+		}
+		else if (arg == "--client-budget" && i + 1 < argc)
+		{
+			client_budget = static_cast<uint32_t>(std::clamp(std::atoi(argv[++i]), 1024, 1 << 30));
+		}
+		else if (arg == "--control-port" && i + 1 < argc)
+		{
+			// 0 leaves the TCP control channel closed
+			control_port = std::clamp(std::atoi(argv[++i]), 0, 65535);
+		}
+		else if (arg == "--metrics-port" && i + 1 < argc)
+		{
+			// Prometheus scrape endpoint on 127.0.0.1; 0 (the default) leaves it closed
+			metrics_port = std::clamp(std::atoi(argv[++i]), 0, 65535);
+		}
+		else if (arg == "--metrics-file" && i + 1 < argc)
+		{
+			metrics_file = argv[++i];
+		}
+		else if (arg == "--wire-report")
+		{
+			// Round-trip check of the wire encoding; no socket is opened.
+			return WireReport(std::cout) ? 0 : 1;
 		}
 	}
 
-	// If all clients are connected, send the game start signal
-	if (allClientsConnected)
-	{
-		SendToAllClients("StartGame");
-	}
-}
-
-int main()
-{
-	//std::cout << "Server UDP Port Number: ";
-	uint16_t udp_port{9000};
-
 	//std::cin >> udp_port;
 	const std::string udp_port_string = std::to_string(udp_port);
 	std::cout << std::endl;
 
-	WSADATA wsaData{};
-
-	int errorCode = WSAStartup(MAKEWORD(2, 2), &wsaData);
-	if (errorCode != NO_ERROR)
+	if (!net_startup())
 	{
 		std::cerr << "WSAStartup() failed." << std::endl;
-		return errorCode;
+		return 1;
 	}
 
 	addrinfo udp_hints{};
-	SecureZeroMemory(&udp_hints, sizeof(udp_hints));
 	udp_hints.ai_family = AF_INET;			// IPv4
 	// For UDP use SOCK_DGRAM instead of SOCK_STREAM.
 	udp_hints.ai_socktype = SOCK_DGRAM;	// Reliable delivery
@@ -328,16 +331,16 @@ int main()
 	char hostName[NI_MAXHOST];
 	if (gethostname(hostName, NI_MAXHOST) != 0) {
 		std::cerr << "gethostname() failed." << std::endl;
-		WSACleanup();
+		net_cleanup();
 		return 2;
 	}
 
 	addrinfo* udp_info = nullptr;
-	errorCode = getaddrinfo(hostName, udp_port_string.c_str(), &udp_hints, &udp_info);
+	int errorCode = getaddrinfo(hostName, udp_port_string.c_str(), &udp_hints, &udp_info);
 	if ((errorCode) || (udp_info == nullptr))
 	{
 		std::cerr << "getaddrinfo() failed." << std::endl;
-		WSACleanup();
+		net_cleanup();
 		return errorCode;
 	}
 
@@ -345,27 +348,24 @@ int main()
 	char udp_port_buffer[NI_MAXSERV];
 	errorCode = getnameinfo(
 		udp_info->ai_addr,
-		static_cast<int>(udp_info->ai_addrlen),
+		static_cast<socklen_t>(udp_info->ai_addrlen),
 		ipBuffer,
 		NI_MAXHOST,
 		udp_port_buffer,
 		NI_MAXSERV,
 		NI_NUMERICHOST);
 
+	freeaddrinfo(udp_info);
 	if (errorCode != 0)
 	{
-		freeaddrinfo(udp_info);
-		WSACleanup();
+		net_cleanup();
 		return errorCode;
 	}
 
 	std::cout << "Server IP Address: " << ipBuffer << "\n";
 	std::cout << "Server UDP Port Number: " << udp_port_buffer << "\n";
 
-	HANDLE hInput = GetStdHandle(STD_INPUT_HANDLE);
-	DWORD mode;
-	GetConsoleMode(hInput, &mode);
-	SetConsoleMode(hInput, mode & (~ENABLE_ECHO_INPUT) & (~ENABLE_LINE_INPUT));
+	disable_console_echo();
 
 	udp_listener_socket = socket(
 		udp_hints.ai_family,
@@ -374,394 +374,141 @@ int main()
 	if (udp_listener_socket == INVALID_SOCKET)
 	{
 		std::cerr << "socket() failed." << std::endl;
-		WSACleanup();
+		net_cleanup();
 		return 1;
 	}
 
+	// Bind to the wildcard address so the clients' broadcast handshake reaches us
+	// whichever interface the host name resolves to (127.0.1.1 on most Linux hosts).
+	sockaddr_in local_endpoint{};
+	local_endpoint.sin_family = AF_INET;
+	local_endpoint.sin_addr.s_addr = htonl(INADDR_ANY);
+	local_endpoint.sin_port = htons(udp_port);
+
 	errorCode = bind(
 		udp_listener_socket,
-		udp_info->ai_addr,
-		static_cast<int>(udp_info->ai_addrlen));
+		(SOCKADDR*)&local_endpoint,
+		sizeof(local_endpoint));
 	if (errorCode != NO_ERROR)
 	{
 		std::cerr << "bind() failed." << std::endl;
 		closesocket(udp_listener_socket);
-		udp_listener_socket = INVALID_SOCKET;
-	}
-
-	char recvBuffer[1024];
-	sockaddr_in clientAddr;
-	int clientAddrSize = sizeof(clientAddr);
-
-	bool game_start = false;
-
-	while (true) 
-	{
-		if(!game_start)
-		{
-			int bytesReceived = recvfrom(udp_listener_socket, recvBuffer, sizeof(recvBuffer), 0, (SOCKADDR*)&clientAddr, &clientAddrSize);
-			if (bytesReceived == SOCKET_ERROR)
-			{
-				std::cerr << "recvfrom failed with error: " << WSAGetLastError() << '\n';
-				closesocket(udp_listener_socket);
-				WSACleanup();
-				return 1;
-			}
-
-			recvBuffer[bytesReceived] = '\0';
-			std::cout << "Received message from client: " << recvBuffer << '\n';
-
-			// Process the message and send a response
-			std::string player_num = std::to_string(numConnectedPlayers);
-			const char* responseMessage = player_num.c_str();
-			sendto(udp_listener_socket, responseMessage, strlen(responseMessage), 0, (SOCKADDR*)&clientAddr, sizeof(clientAddr));
-			numConnectedPlayers++;
-
-			clients.push_back({ clientAddr, true, numConnectedPlayers});
-
-			if(numConnectedPlayers >= MAX_PLAYERS)
-			{
-				std::string max_player_num = std::to_string(MAX_PLAYERS);
-				const char* responseMessage = max_player_num.c_str();
-				SendToAllClients(responseMessage);
-				game_start = true;
-			}
-		}
-		else
-		{
-			asteroid_timer += delta_time.GetDeltaTime();
-			if (asteroid_timer > ASTEROID_TIME)
-			{
-				asteroid_timer -= ASTEROID_TIME;
-				spawnAsteroid(1);
-			}
-
-			SendPlayersPosToAllClients();
-			//SendAsteroidDataToAllClients();
-		}
-
+		net_cleanup();
+		return 1;
 	}
 
-	// Close the listener socket
-	closesocket(udp_listener_socket);
-	WSACleanup();
-}
-
-/*
-* brief: get client's ip and port
-* param: socket
-* param: ip
-* param: port
-*/
-void get_client_IP_and_port(SOCKET socket, char ip[NI_MAXHOST], char port[NI_MAXSERV])
-{
-	sockaddr_storage addr;
-	int addrLen = sizeof(addr);
-
-	// Retrieve the client's address information
-	if (getpeername(socket, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0)
-	{
-		getnameinfo(reinterpret_cast<sockaddr*>(&addr),
-			addrLen,
-			ip,
-			NI_MAXHOST,
-			port,
-			NI_MAXSERV,
-			NI_NUMERICHOST | NI_NUMERICSERV);
-	}
-	else
+	// The loop never blocks inside recvfrom; it sleeps in the event loop instead.
+	if (!set_nonblocking(udp_listener_socket, true))
 	{
-		std::cerr << "getpeername() failed." << std::endl;
+		std::cerr << "set_nonblocking() failed." << std::endl;
+		closesocket(udp_listener_socket);
+		net_cleanup();
+		return 1;
 	}
-}
-
-/*
-*biref: respond to echo request
-*param: socket
-*param: message
-*param: cmd_id
-*/
-int respond_echo(SOCKET socket, std::string const& message, CMDID cmd_id)
-{
-	//find destination port
-	uint32_t ipAddrdest = *reinterpret_cast<const uint32_t*>(&message[sizeof(uint8_t)]);
-	uint16_t portNumdest = ntohs(*reinterpret_cast<const uint16_t*>(&message[sizeof(uint8_t) + sizeof(uint32_t)]));
-
-	// Convert IP address to string
-	char ipBuffer[INET_ADDRSTRLEN];
-	inet_ntop(AF_INET, &ipAddrdest, ipBuffer, sizeof(ipBuffer));
-	std::string ip(ipBuffer);
-
-	// Convert port number to string
-	std::string port = std::to_string(portNumdest);
 
-	std::string ip_port = ip;
-	ip_port += ":";
-	ip_port += port;
-
-	if (!client_port.contains(ip_port))
+	EventLoop event_loop;
+	if (!event_loop.add(udp_listener_socket))
 	{
-		std::vector<char> buffer(1);
-
-		uint8_t cmdId = static_cast<uint8_t>(CMDID::ECHO_ERROR);
-		std::memcpy(&buffer[0], &cmdId, sizeof(uint8_t));
-
-		int err = send(socket, buffer.data(), static_cast<int>(buffer.size()), 0);
-		return err;
+		std::cerr << "EventLoop::add() failed." << std::endl;
+		closesocket(udp_listener_socket);
+		net_cleanup();
+		return 1;
 	}
 
-	SOCKET dest_socket = client_port.at(ip_port);
-
-	// CMD ID: 1 byte
-	// IP address: 4 bytes, in network byte order
-	// Port number: 2 bytes, in network byte order
-	// Text length: 4 bytes, in network byte order
-	// Text: Variable length, as specified by the text length field
-
-	size_t totalLength = message.length();
-	std::vector<char> buffer(totalLength);
-
-	uint8_t cmdId = static_cast<uint8_t>(cmd_id);
-	std::memcpy(&buffer[0], &cmdId, sizeof(uint8_t));
-
-	// Source IP address and port number
-	sockaddr_in addr{};
-	int addrLen = sizeof(addr);
-	getpeername(socket, reinterpret_cast<sockaddr*>(&addr), &addrLen);
-
-	uint32_t ipAddr = addr.sin_addr.s_addr;
-	uint16_t portNum = ntohs(addr.sin_port);
-
-	// Convert IP address to network byte order
-	uint32_t ipAddrNet = ipAddr;
-	// Copy IP address
-	std::memcpy(&buffer[sizeof(uint8_t)], &ipAddrNet, sizeof(uint32_t));
-
-	// Convert port number to network byte order
-	uint16_t portNumNet = htons(portNum);
-	// Copy port number
-	std::memcpy(&buffer[sizeof(uint8_t) + sizeof(uint32_t)], &portNumNet, sizeof(uint16_t));
-
-	// Calculate the length of the message part (excluding header fields)
-	size_t messagePartLength = message.length() - sizeof(uint16_t) - sizeof(uint32_t) - sizeof(uint8_t);
-
-	// Create a substring containing only the message part
-	std::string messagePart = message.substr(sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint8_t), messagePartLength);
-
-	//extract message from message part and convert to string
-	std::string message_extracted = messagePart.substr(sizeof(uint32_t), messagePartLength - sizeof(uint32_t));
-
-	// Copy the message part into the buffer
-	std::memcpy(&buffer[sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint16_t)], messagePart.c_str(), messagePart.length());
-
-	uint32_t total_length = static_cast<uint32_t>(message.length());
-	// Send the message
-	int err{};
-
-	while (err < static_cast<int>(total_length))
+	// Admin commands share this thread and loop with the game datagrams.
+	ControlChannel control_channel(event_loop);
+	if (control_port != 0)
 	{
-		//err = send(dest_socket, buffer.data(), static_cast<int>(buffer.size()), 0);
-		int remainingBytes = static_cast<int>(total_length) - err;
-		int bytesSent = send(dest_socket, buffer.data() + err, remainingBytes, 0);
-		if (bytesSent <= 0) {
-			std::cerr << "Error sending message." << std::endl;
-			return -1;
+		if (!control_channel.listen(static_cast<uint16_t>(control_port)))
+		{
+			event_loop.remove(udp_listener_socket);
+			closesocket(udp_listener_socket);
+			net_cleanup();
+			return 1;
 		}
-		err += bytesSent;
+		std::cout << "Server TCP Control Port: " << control_port << "\n";
 	}
-	return err;
-}
-
-/*
-*brief: respond to list user request
-*param: socket
-*/
-int respond_list_user(SOCKET socket)
-{
-	// Prepare the message
-	std::vector<char> buffer(3);
-
-	uint16_t numUsers = static_cast<uint16_t>(client_port.size());
-	uint16_t numUsersNetOrder = htons(numUsers);
-
-	size_t offset = 3; // Start offset after commandId and numUsers
-
-	size_t bufferSize;
 
-	buffer[0] = static_cast<char>(RSP_LISTUSERS);
-
-	// Number of users (assuming client_port is your map)
-	std::memcpy(&buffer[1], &numUsersNetOrder, sizeof(uint16_t));
-
-	// Resize the buffer to accommodate the maximum possible size
-	bufferSize = buffer.size() + (client_port.size() * (sizeof(uint32_t) + sizeof(uint16_t)));
-	buffer.resize(bufferSize);
-
-	// Append each user's IP address and port number
-	for (const auto& [ip_port, socket] : client_port)
+	MetricsEndpoint metrics_endpoint(event_loop, Metrics());
+	if (metrics_port != 0)
 	{
-		size_t colon_pos = ip_port.find(':');
-		if (colon_pos == std::string::npos)
+		if (!metrics_endpoint.listen(static_cast<uint16_t>(metrics_port)))
 		{
-			std::cerr << "Invalid key format in client_port map: " << ip_port << std::endl;
-			continue;
+			event_loop.remove(udp_listener_socket);
+			closesocket(udp_listener_socket);
+			net_cleanup();
+			return 1;
 		}
-
-		std::string ip = ip_port.substr(0, colon_pos);
-		std::string port_str = ip_port.substr(colon_pos + 1);
-		uint16_t port = static_cast<uint16_t>(std::stoi(port_str));
-
-		sockaddr_in addr{};
-		addr.sin_family = AF_INET;
-		inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
-		uint32_t ipAddr = addr.sin_addr.s_addr;
-		uint16_t portNum = htons(port);
-
-		// Append IP address
-		std::memcpy(&buffer[offset], &ipAddr, sizeof(uint32_t));
-		offset += sizeof(uint32_t);
-
-		// Append port number
-		std::memcpy(&buffer[offset], &portNum, sizeof(uint16_t));
-		offset += sizeof(uint16_t);
+		std::cout << "Server Metrics Port: 127.0.0.1:" << metrics_port << "\n";
 	}
-
-	int err = send(socket, buffer.data(), static_cast<int>(buffer.size()), 0);
-	return err;
-}
-
-/*
-*brief: send unknown command
-*param: socket
-*/
-void send_unknown(SOCKET socket)
-{
-	std::vector<char> buffer(1);
-	buffer[0] = static_cast<char>(UNKNOWN);
-	send(socket, buffer.data(), static_cast<int>(buffer.size()), 0);
-}
-
-/*
-*brief: send message
-*param: socket
-*param: commandId
-*param: message
-*/
-int send_message(SOCKET socket, CMDID commandId, const std::string& message)
-{
-	switch (commandId)
+	if (!metrics_file.empty())
 	{
-	case REQ_LISTUSERS:
-		respond_list_user(socket);
-		break;
-	case UNKNOWN:
-		send_unknown(socket);
-		break;
-	default:
-		break;
+		std::cout << "Server Metrics File: " << metrics_file << "\n";
 	}
 
-	return 0;
-}
-
-/*
-*brief: remove client from map
-*param: socket
-*/
-void remove_client(SOCKET socket)
-{
-	char ipBuffer[NI_MAXHOST];
-	char portBuffer[NI_MAXSERV];
-
-	get_client_IP_and_port(socket, ipBuffer, portBuffer);
-
-	std::string ip_port = ipBuffer;
-	ip_port += ":";
-	ip_port += portBuffer;
+	std::cout << "Server Tick Rate: " << tick_rate << "Hz\n";
+	std::cout << "Server Match Workers: " << worker_count << "\n";
+	std::cout << "Server Client Budget: " << client_budget << " bytes/s\n";
 
-	auto it = client_port.find(ip_port);
-	if (it != client_port.end())
+	// Each worker ticks its own matches; this thread only receives and routes.
+	for (int i = 0; i < worker_count; ++i)
 	{
-		client_port.erase(it);
+		workers.push_back(std::make_unique<MatchWorker>(static_cast<size_t>(i), tick_rate, MAX_CATCH_UP_TICKS));
+		workers.back()->start();
 	}
-}
 
-/*
-*brief: receive message
-*param: socket
-*param: message
-*/
-CMDID receive_message(SOCKET socket, const std::string& message)
-{
-	CMDID cmd_id = static_cast<CMDID>(message[0]);
-	switch (cmd_id)
+	auto next_sweep = std::chrono::steady_clock::now() + std::chrono::milliseconds(SESSION_SWEEP_MS);
+	auto next_dump = std::chrono::steady_clock::now() + std::chrono::seconds(METRICS_DUMP_SECONDS);
+	while (true) 
 	{
-	case REQ_QUIT:
-		remove_client(socket);
-		break;
-	case REQ_LISTUSERS:
-		send_message(socket, REQ_LISTUSERS, {});
-		break;
-	default:
-		send_message(socket, UNKNOWN, {});
-		break;
-	}
-	return cmd_id;
-}
-
-/*
-*brief: handle message
-*param: socket
-*/
-bool handle_message(SOCKET socket)
-{
-	bool stay = true;
-
-	constexpr size_t BUFFER_SIZE = 50;
-	char buffer[BUFFER_SIZE];
-
-	std::string partial_message{};
-	bool start_of_message{ true };
-	uint32_t message_length{};
+		// Sleep until a datagram arrives or the idle sweep is due.
+		int ready = event_loop.wait(SESSION_SWEEP_MS);
+		if (ready < 0)
+		{
+			std::cerr << "EventLoop::wait() failed with error: " << WSAGetLastError() << '\n';
+			break;
+		}
 
-	while (true)
-	{
-		u_long mode = 1; // 1 for non-blocking mode, 0 for blocking mode
-		ioctlsocket(socket, FIONBIO, &mode);
-		const int bytesReceived = recv(
-			socket,
-			buffer,
-			BUFFER_SIZE - 1,
-			0);
-		if (bytesReceived == SOCKET_ERROR)
+		for (int i = 0; i < ready; ++i)
 		{
-			size_t errorCode = WSAGetLastError();
-			if (errorCode == WSAEWOULDBLOCK)
+			SOCKET socket = event_loop.ready(i);
+			if (socket == udp_listener_socket)
 			{
-				using namespace std::chrono_literals;
-				std::this_thread::sleep_for(200ms);
-
-				std::lock_guard<std::mutex> usersLock{ _stdoutMutex };
-				continue;
+				ReceiveDatagrams();
+			}
+			else if (control_channel.owns(socket))
+			{
+				control_channel.on_ready(socket);
+			}
+			else if (metrics_endpoint.owns(socket))
+			{
+				metrics_endpoint.on_ready(socket);
 			}
-			break;
 		}
-		if (bytesReceived == 0)
+
+		if (std::chrono::steady_clock::now() >= next_sweep)
 		{
-			break;
+			next_sweep += std::chrono::milliseconds(SESSION_SWEEP_MS);
+			EvictIdleSessions();
 		}
 
-		buffer[bytesReceived] = '\0';
-		std::string text(buffer, bytesReceived);
-
-		receive_message(socket, text);
+		if (!metrics_file.empty() && std::chrono::steady_clock::now() >= next_dump)
+		{
+			next_dump += std::chrono::seconds(METRICS_DUMP_SECONDS);
+			if (!Metrics().write_file(metrics_file))
+			{
+				std::cerr << "could not write metrics to " << metrics_file << '\n';
+			}
+		}
 	}
 
-	shutdown(socket, SD_BOTH);
+	// Stop the workers before the socket they send on goes away
+	workers.clear();
 
-	closesocket(socket);
-
-	return stay;
+	// Close the listener socket
+	event_loop.remove(udp_listener_socket);
+	closesocket(udp_listener_socket);
+	net_cleanup();
 }
 
 /*
@@ -777,95 +524,3 @@ void disconnect(SOCKET& listenerSocket)
 		listenerSocket = INVALID_SOCKET;
 	}
 }
-
-float RandFloat()
-{
-	return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
-}
-
-void Vec2Set(Vec2* vec, float x, float y) {
-	vec->x = x;
-	vec->y = y;
-}
-
-void Vec2Scale(Vec2* result, const Vec2* vec, float scale) {
-	result->x = vec->x * scale;
-	result->y = vec->y * scale;
-}
-
-void spawnAsteroid(unsigned int count)
-{
-	for (unsigned int i = 0; i < count; ++i)
-	{
-		// for activating object instance 
-		Vec2 pos, vel;
-
-		// random size
-		float size = RandFloat() * ASTEROID_SIZE + ASTEROID_SIZE;
-
-		// random rotation
-		float rot = RandFloat() * 360.0f;
-
-		// random direction
-		Vec2Set(&vel, cosf(rot), sinf(rot));
-
-		// random speed 
-		int dir = (int)(RandFloat() * 2.0f);
-		switch (dir)
-		{
-		case 0:
-
-		case 1:
-			Vec2Scale(&vel, &vel, ASTEROID_SPEED + RandFloat() * ASTEROID_SPEED);
-			break;
-
-		case 2:
-			Vec2Scale(&vel, &vel, ASTEROID_SPEED - RandFloat() * -ASTEROID_SPEED);
-			break;
-
-		default:
-			break;
-
-		}
-
-		// random position,   outside the window
-		// random window side
-		int side = (int)(RandFloat() * 5.0f);
-
-		// set half window width and height global variables
-		float HALF_WIDTH = (float)WINDOW_WIDTH / 2.0f;	// half screen width 
-
-		float HALF_HEIGHT = (float)WINDOW_HEIGHT / 2.0f;	// half screen height
-
-		// spawn   selected side
-		switch (side)
-		{
-		case 0: // fall through
-		case 1: //   top left
-			Vec2Set(&pos, (-RandFloat() * HALF_WIDTH - size), (HALF_HEIGHT + size));
-			break;
-
-		case 2: //   top right
-			Vec2Set(&pos, (RandFloat() * HALF_WIDTH + size), (HALF_HEIGHT + size));
-			break;
-
-		case 3: //   bottom left
-			Vec2Set(&pos, (-RandFloat() * HALF_WIDTH - size), (-HALF_HEIGHT - size));
-			break;
-
-		case 4:
-
-		case 5: //   bottom right
-			Vec2Set(&pos, (RandFloat() * HALF_WIDTH + size), (-HALF_HEIGHT - size));
-			break;
-
-		default:
-			break;
-
-		}
-
-		// spawn asteroid by activating a game object instance
-		ASTEROID asteroid(asteroid_id++,true, size, pos, vel, rot);
-		asteroids_list.push_back(asteroid);
-	}
-}
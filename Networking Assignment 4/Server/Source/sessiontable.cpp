@@ -0,0 +1,98 @@
+/******************************************************************************/
+/*!
+\file		sessiontable.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Endpoint keys for the session table
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "sessiontable.h"
+
+#include <cstring>
+
+namespace
+{
+	/*
+	* brief: murmur3's 64-bit finalizer; spreads every input bit over the word
+	*/
+	uint64_t Mix(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdull;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+		return value;
+	}
+}
+
+EndpointKey MakeEndpointKey(uint32_t address, uint16_t port)
+{
+	EndpointKey key;
+	key.high = EndpointKey::IPV4_TAG;
+	key.low = (static_cast<uint64_t>(address) << 16) | port;
+	return key;
+}
+
+EndpointKey MakeEndpointKey(const sockaddr_in& address)
+{
+	return MakeEndpointKey(static_cast<uint32_t>(address.sin_addr.s_addr), address.sin_port);
+}
+
+EndpointKey MakeEndpointKey(const sockaddr_in6& address)
+{
+	EndpointKey key;
+	memcpy(&key.high, &address.sin6_addr, sizeof(key.high));
+	memcpy(&key.low, reinterpret_cast<const char*>(&address.sin6_addr) + sizeof(key.high), sizeof(key.low));
+	key.port = address.sin6_port;
+	return key;
+}
+
+EndpointKey MakeEndpointKey(const sockaddr_storage& address)
+{
+	if (address.ss_family == AF_INET)
+	{
+		return MakeEndpointKey(reinterpret_cast<const sockaddr_in&>(address));
+	}
+	if (address.ss_family == AF_INET6)
+	{
+		return MakeEndpointKey(reinterpret_cast<const sockaddr_in6&>(address));
+	}
+	return EndpointKey{};
+}
+
+size_t HashEndpointKey(const EndpointKey& key)
+{
+	return static_cast<size_t>(Mix(key.low ^ Mix(key.high ^ key.port)));
+}
+
+std::string EndpointKeyString(const EndpointKey& key)
+{
+	char ipBuffer[INET6_ADDRSTRLEN] = {};
+	uint16_t port;
+	if (key.is_ipv4())
+	{
+		uint32_t address = key.ipv4_address();
+		inet_ntop(AF_INET, &address, ipBuffer, sizeof(ipBuffer));
+		port = key.ipv4_port();
+	}
+	else
+	{
+		unsigned char address[16];
+		memcpy(address, &key.high, sizeof(key.high));
+		memcpy(address + sizeof(key.high), &key.low, sizeof(key.low));
+		inet_ntop(AF_INET6, address, ipBuffer, sizeof(ipBuffer));
+		port = key.port;
+	}
+
+	std::string text = ipBuffer;
+	text += ":";
+	text += std::to_string(ntohs(port));
+	return text;
+}
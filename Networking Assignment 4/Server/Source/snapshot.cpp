@@ -0,0 +1,196 @@
+/******************************************************************************/
+/*!
+\file		snapshot.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Delta-compressed world snapshots
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "wireformat.h"
+
+namespace
+{
+	// Every player compares against this when there is no baseline.
+	const Player EMPTY_PLAYER{};
+	const std::vector<Bullet> EMPTY_BULLETS{};
+
+	// Bits in the per-player field mask
+	const unsigned FIELD_MASK_BITS = 6;
+
+	template <typename T>
+	void Write(std::vector<char>& out, const T& value)
+	{
+		size_t offset = out.size();
+		out.resize(offset + sizeof(T));
+		memcpy(out.data() + offset, &value, sizeof(T));
+	}
+
+	// Values are compared as they would arrive, so jitter below one quantization
+	// step does not count as a change.
+	bool SamePosition(const Vec2& a, const Vec2& b)
+	{
+		return QuantizePosX(a.x) == QuantizePosX(b.x) && QuantizePosY(a.y) == QuantizePosY(b.y);
+	}
+
+	bool SameVelocity(const Vec2& a, const Vec2& b)
+	{
+		return QuantizeVelocity(a.x) == QuantizeVelocity(b.x) && QuantizeVelocity(a.y) == QuantizeVelocity(b.y);
+	}
+
+	bool SameBullet(const Bullet& a, const Bullet& b)
+	{
+		return a.player_id == b.player_id && SamePosition(a.position, b.position);
+	}
+
+	bool SameBullets(const std::vector<Bullet>& a, const std::vector<Bullet>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (!SameBullet(a[i], b[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/*
+	* brief: append one player's changed fields and bullets
+	*/
+	void EncodePlayer(const Player& player, const std::vector<Bullet>& bullets,
+		const Player& base, const std::vector<Bullet>& baseBullets, BitWriter& out)
+	{
+		uint8_t mask = 0;
+		if (player.player_id != base.player_id)				mask |= SF_PLAYER_ID;
+		if (player.shoot != base.shoot)						mask |= SF_SHOOT;
+		if (!SamePosition(player.position, base.position))	mask |= SF_POSITION;
+		if (!SameVelocity(player.velocity, base.velocity))	mask |= SF_VELOCITY;
+		if (QuantizeAngle(player.direction) != QuantizeAngle(base.direction))
+		{
+			mask |= SF_DIRECTION;
+		}
+		if (!SameBullets(bullets, baseBullets))				mask |= SF_BULLETS;
+
+		out.write(mask, FIELD_MASK_BITS);
+		if (mask & SF_PLAYER_ID)	out.write(static_cast<uint32_t>(player.player_id), WIRE_FORMAT.player_id_bits);
+		if (mask & SF_SHOOT)		out.write_bool(player.shoot);
+		if (mask & SF_POSITION)		WritePosition(out, player.position);
+		if (mask & SF_VELOCITY)		WriteVelocity(out, player.velocity);
+		if (mask & SF_DIRECTION)	WriteAngle(out, player.direction);
+
+		if (mask & SF_BULLETS)
+		{
+			size_t count = std::min(bullets.size(), static_cast<size_t>((1u << WIRE_FORMAT.bullet_count_bits) - 1));
+			out.write(static_cast<uint32_t>(count), WIRE_FORMAT.bullet_count_bits);
+
+			// One bit per bullet; set if it is new or moved since the baseline.
+			for (size_t i = 0; i < count; ++i)
+			{
+				out.write_bool(i >= baseBullets.size() || !SameBullet(bullets[i], baseBullets[i]));
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (i >= baseBullets.size() || !SameBullet(bullets[i], baseBullets[i]))
+				{
+					WriteBullet(out, bullets[i]);
+				}
+			}
+		}
+	}
+}
+
+SnapshotHistory::SnapshotHistory(size_t capacity, size_t player_count, size_t max_bullets) :
+	_ring(capacity)
+{
+	for (WorldSnapshot& snapshot : _ring)
+	{
+		snapshot.players.resize(player_count);
+		snapshot.bullets.resize(player_count);
+		for (std::vector<Bullet>& bullets : snapshot.bullets)
+		{
+			bullets.reserve(max_bullets);
+		}
+	}
+}
+
+/*
+* brief: claim the slot for a new sequence
+* param: sequence
+*/
+WorldSnapshot& SnapshotHistory::push(uint32_t sequence)
+{
+	WorldSnapshot& slot = _ring[sequence % _ring.size()];
+	slot.sequence = sequence;
+	return slot;
+}
+
+/*
+* brief: find a snapshot that is still in the ring
+* param: sequence
+*/
+const WorldSnapshot* SnapshotHistory::find(uint32_t sequence) const
+{
+	if (sequence == 0)
+	{
+		return nullptr;
+	}
+	const WorldSnapshot& slot = _ring[sequence % _ring.size()];
+	return slot.sequence == sequence ? &slot : nullptr;
+}
+
+/*
+* brief: encode current against baseline into out
+* param: current
+* param: baseline
+* param: out
+*/
+size_t EncodeSnapshotDelta(const WorldSnapshot& current, const WorldSnapshot* baseline, std::vector<char>& out)
+{
+	out.clear();
+
+	Write(out, SNAPSHOT_DELTA);
+	Write(out, current.sequence);
+	Write(out, baseline ? baseline->sequence : uint32_t{ 0 });
+	Write(out, static_cast<uint8_t>(current.players.size()));
+
+	BitWriter bits(out);
+
+	for (size_t i = 0; i < current.players.size(); ++i)
+	{
+		const Player& base = baseline ? baseline->players[i] : EMPTY_PLAYER;
+		const std::vector<Bullet>& baseBullets = baseline ? baseline->bullets[i] : EMPTY_BULLETS;
+		EncodePlayer(current.players[i], current.bullets[i], base, baseBullets, bits);
+	}
+	bits.flush();
+
+	return out.size();
+}
+
+/*
+* brief: size of the snapshot in the raw SEND_PLAYERS layout
+* param: snapshot
+*/
+size_t RawSnapshotSize(const WorldSnapshot& snapshot)
+{
+	size_t size = sizeof(CMDID) + snapshot.players.size() * sizeof(Player);
+	for (const std::vector<Bullet>& bullets : snapshot.bullets)
+	{
+		size += bullets.size() * sizeof(Bullet);
+	}
+	return size;
+}
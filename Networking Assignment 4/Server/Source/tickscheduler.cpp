@@ -0,0 +1,138 @@
+/******************************************************************************/
+/*!
+\file		tickscheduler.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Fixed-rate tick scheduler for the server loop
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "tickscheduler.h"
+
+#include <algorithm>
+#include <ostream>
+
+// Number of recent ticks the percentiles are computed over
+constexpr size_t TICK_SAMPLE_WINDOW = 1024;
+
+TickScheduler::TickScheduler(int tick_rate, int max_catch_up) :
+	_tick_rate{ std::max(tick_rate, 1) },
+	_max_catch_up{ std::max(max_catch_up, 1) },
+	_tick_seconds{ 1.0f / static_cast<float>(_tick_rate) },
+	_interval{ std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / _tick_rate)) },
+	_next_tick{ clock::now() + _interval },
+	_last_report{ clock::now() },
+	_samples(TICK_SAMPLE_WINDOW),
+	_scratch(TICK_SAMPLE_WINDOW)
+{
+}
+
+/*
+* brief: milliseconds until the next tick deadline
+*/
+int TickScheduler::timeout_ms() const
+{
+	clock::time_point now = clock::now();
+	if (_next_tick <= now)
+	{
+		return 0;
+	}
+	return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(_next_tick - now).count());
+}
+
+/*
+* brief: number of simulation steps due now; starts timing the tick
+*/
+int TickScheduler::begin()
+{
+	clock::time_point now = clock::now();
+	if (now < _next_tick)
+	{
+		return 0;
+	}
+
+	// Every whole interval that passed since the deadline is another step owed.
+	int64_t due = 1 + (now - _next_tick) / _interval;
+	int steps = static_cast<int>(std::min<int64_t>(due, _max_catch_up));
+	if (due > 1)
+	{
+		++_late_ticks;
+	}
+
+	_next_tick += _interval * steps;
+	if (due > _max_catch_up)
+	{
+		// Too far behind to catch up; drop the remainder and realign on now.
+		_dropped_ticks += static_cast<uint64_t>(due - _max_catch_up);
+		_next_tick = now + _interval;
+	}
+
+	_tick_start = now;
+	return steps;
+}
+
+/*
+* brief: stop timing the current tick and record its duration
+*/
+void TickScheduler::end()
+{
+	clock::duration elapsed = clock::now() - _tick_start;
+	if (elapsed > _interval)
+	{
+		++_overruns;
+	}
+
+	int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	_samples[_sample_count % _samples.size()] = static_cast<uint32_t>(std::min<int64_t>(us, UINT32_MAX));
+	++_sample_count;
+	++_ticks;
+}
+
+/*
+* brief: tick duration percentile over the recent window
+* param: p
+*/
+uint32_t TickScheduler::percentile_us(double p) const
+{
+	size_t count = std::min(_sample_count, _samples.size());
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	std::copy(_samples.begin(), _samples.begin() + count, _scratch.begin());
+	size_t rank = static_cast<size_t>(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(count - 1));
+	std::nth_element(_scratch.begin(), _scratch.begin() + rank, _scratch.begin() + count);
+	return _scratch[rank];
+}
+
+/*
+* brief: write a summary line every report_interval
+* param: os
+* param: report_interval
+*/
+bool TickScheduler::report(std::ostream& os, std::chrono::seconds report_interval)
+{
+	clock::time_point now = clock::now();
+	if (now - _last_report < report_interval)
+	{
+		return false;
+	}
+	_last_report = now;
+
+	os << "Tick " << _tick_rate << "Hz"
+		<< " ticks=" << _ticks
+		<< " p50=" << percentile_us(50.0) << "us"
+		<< " p99=" << percentile_us(99.0) << "us"
+		<< " max=" << percentile_us(100.0) << "us"
+		<< " overruns=" << _overruns
+		<< " late=" << _late_ticks
+		<< " dropped=" << _dropped_ticks
+		<< std::endl;
+	return true;
+}
@@ -0,0 +1,351 @@
+/******************************************************************************/
+/*!
+\file		wireformat.cpp
+\author     goh.a@digipen.edu
+
+\date   	March 27 2025
+\brief		Quantized, bit-packed wire encoding
+
+Copyright (C) 2023 DigiPen Institute of Technology.
+Reproduction or disclosure of this file or its contents without the
+prior written consent of DigiPen Institute of Technology is prohibited.
+ */
+ /******************************************************************************/
+
+#include "wireformat.h"
+
+#include <algorithm>
+#include <cmath>
+
+const WireFormat WIRE_FORMAT{};
+
+namespace
+{
+	const float TWO_PI = 6.28318531f;
+
+	uint32_t Mask(unsigned bits)
+	{
+		return bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+	}
+}
+
+/*
+* brief: append the low bits of value
+* param: value
+* param: bits
+*/
+void BitWriter::write(uint32_t value, unsigned bits)
+{
+	_acc |= static_cast<uint64_t>(value & Mask(bits)) << _pending;
+	_pending += bits;
+	_bits += bits;
+	while (_pending >= 8)
+	{
+		_out.push_back(static_cast<char>(_acc & 0xFF));
+		_acc >>= 8;
+		_pending -= 8;
+	}
+}
+
+/*
+* brief: write out the last partial byte
+*/
+void BitWriter::flush()
+{
+	if (_pending > 0)
+	{
+		_out.push_back(static_cast<char>(_acc & 0xFF));
+		_bits += 8 - _pending;
+	}
+	_acc = 0;
+	_pending = 0;
+}
+
+BitReader::BitReader(const char* data, size_t size) :
+	_ptr{ reinterpret_cast<const uint8_t*>(data) },
+	_end{ reinterpret_cast<const uint8_t*>(data) + size }
+{
+}
+
+/*
+* brief: take the next value of the given width
+* param: bits
+*/
+uint32_t BitReader::read(unsigned bits)
+{
+	while (_pending < bits)
+	{
+		if (_ptr == _end)
+		{
+			_ok = false;
+			return 0;
+		}
+		_acc |= static_cast<uint64_t>(*_ptr++) << _pending;
+		_pending += 8;
+	}
+	uint32_t value = static_cast<uint32_t>(_acc) & Mask(bits);
+	_acc >>= bits;
+	_pending -= bits;
+	return value;
+}
+
+/*
+* brief: map a value onto the field's integer steps
+* param: value
+*/
+uint32_t QuantizedField::quantize(float value) const
+{
+	float t = (std::clamp(value, min, max) - min) / (max - min);
+	return static_cast<uint32_t>(t * static_cast<float>(Mask(bits)) + 0.5f);
+}
+
+/*
+* brief: map integer steps back onto the field's range
+* param: q
+*/
+float QuantizedField::dequantize(uint32_t q) const
+{
+	return min + (max - min) * (static_cast<float>(q & Mask(bits)) / static_cast<float>(Mask(bits)));
+}
+
+uint32_t QuantizePosX(float value, const WireFormat& format)
+{
+	return format.position_x.quantize(value);
+}
+
+uint32_t QuantizePosY(float value, const WireFormat& format)
+{
+	return format.position_y.quantize(value);
+}
+
+uint32_t QuantizeVelocity(float value, const WireFormat& format)
+{
+	return format.velocity.quantize(value);
+}
+
+/*
+* brief: wrap to [-pi, pi] first so a ship that spun a few times still fits
+* param: radians
+*/
+uint32_t QuantizeAngle(float radians, const WireFormat& format)
+{
+	return format.angle.quantize(std::remainder(radians, TWO_PI));
+}
+
+void WritePosition(BitWriter& out, const Vec2& position, const WireFormat& format)
+{
+	out.write(QuantizePosX(position.x, format), format.position_x.bits);
+	out.write(QuantizePosY(position.y, format), format.position_y.bits);
+}
+
+void WriteVelocity(BitWriter& out, const Vec2& velocity, const WireFormat& format)
+{
+	out.write(QuantizeVelocity(velocity.x, format), format.velocity.bits);
+	out.write(QuantizeVelocity(velocity.y, format), format.velocity.bits);
+}
+
+void WriteAngle(BitWriter& out, float radians, const WireFormat& format)
+{
+	out.write(QuantizeAngle(radians, format), format.angle.bits);
+}
+
+Vec2 ReadPosition(BitReader& in, const WireFormat& format)
+{
+	Vec2 position;
+	position.x = format.position_x.dequantize(in.read(format.position_x.bits));
+	position.y = format.position_y.dequantize(in.read(format.position_y.bits));
+	return position;
+}
+
+Vec2 ReadVelocity(BitReader& in, const WireFormat& format)
+{
+	Vec2 velocity;
+	velocity.x = format.velocity.dequantize(in.read(format.velocity.bits));
+	velocity.y = format.velocity.dequantize(in.read(format.velocity.bits));
+	return velocity;
+}
+
+float ReadAngle(BitReader& in, const WireFormat& format)
+{
+	return format.angle.dequantize(in.read(format.angle.bits));
+}
+
+void WritePlayer(BitWriter& out, const Player& player, const WireFormat& format)
+{
+	out.write(static_cast<uint32_t>(player.player_id), format.player_id_bits);
+	out.write_bool(player.shoot);
+	WritePosition(out, player.position, format);
+	WriteVelocity(out, player.velocity, format);
+	WriteAngle(out, player.direction, format);
+}
+
+void WriteBullet(BitWriter& out, const Bullet& bullet, const WireFormat& format)
+{
+	out.write(static_cast<uint32_t>(bullet.player_id), format.player_id_bits);
+	WritePosition(out, bullet.position, format);
+}
+
+void WriteAsteroid(BitWriter& out, const ASTEROID& asteroid, const WireFormat& format)
+{
+	out.write(static_cast<uint32_t>(asteroid._id), format.asteroid_id_bits);
+	out.write_bool(asteroid._active);
+	out.write(format.size.quantize(asteroid._size), format.size.bits);
+	WritePosition(out, asteroid._pos, format);
+	WriteVelocity(out, asteroid._vel, format);
+	WriteAngle(out, asteroid._rot, format);
+}
+
+void ReadPlayer(BitReader& in, Player& player, const WireFormat& format)
+{
+	player.player_id = static_cast<int>(in.read(format.player_id_bits));
+	player.shoot = in.read_bool();
+	player.position = ReadPosition(in, format);
+	player.velocity = ReadVelocity(in, format);
+	player.direction = ReadAngle(in, format);
+}
+
+void ReadBullet(BitReader& in, Bullet& bullet, const WireFormat& format)
+{
+	bullet.player_id = static_cast<int>(in.read(format.player_id_bits));
+	bullet.position = ReadPosition(in, format);
+}
+
+void ReadAsteroid(BitReader& in, ASTEROID& asteroid, const WireFormat& format)
+{
+	asteroid._id = static_cast<int>(in.read(format.asteroid_id_bits));
+	asteroid._active = in.read_bool();
+	asteroid._size = format.size.dequantize(in.read(format.size.bits));
+	asteroid._pos = ReadPosition(in, format);
+	asteroid._vel = ReadVelocity(in, format);
+	asteroid._rot = ReadAngle(in, format);
+}
+
+size_t PlayerBits(const WireFormat& format)
+{
+	return format.player_id_bits + 1 + format.position_x.bits + format.position_y.bits +
+		2 * format.velocity.bits + format.angle.bits;
+}
+
+size_t BulletBits(const WireFormat& format)
+{
+	return format.player_id_bits + format.position_x.bits + format.position_y.bits;
+}
+
+size_t AsteroidBits(const WireFormat& format)
+{
+	return format.asteroid_id_bits + 1 + format.size.bits + format.position_x.bits + format.position_y.bits +
+		2 * format.velocity.bits + format.angle.bits;
+}
+
+namespace
+{
+	// Worst absolute error seen per field kind, and whether it stayed in bounds
+	struct ErrorTally
+	{
+		float position = 0.f;
+		float velocity = 0.f;
+		float angle = 0.f;
+		float size = 0.f;
+		bool exact = true;	// integers and bools must survive unchanged
+	};
+
+	float AngleError(float sent, float received)
+	{
+		return std::fabs(std::remainder(sent - received, TWO_PI));
+	}
+
+	void Tally(float& worst, float error)
+	{
+		worst = std::max(worst, error);
+	}
+
+	void TallyVec2(float& worst, const Vec2& a, const Vec2& b)
+	{
+		Tally(worst, std::fabs(a.x - b.x));
+		Tally(worst, std::fabs(a.y - b.y));
+	}
+
+	float Sample(float min, float max, int i, int count)
+	{
+		return min + (max - min) * (static_cast<float>(i) + 0.37f) / static_cast<float>(count);
+	}
+}
+
+/*
+* brief: round-trip a sweep of entities and print the sizes and errors
+* param: out
+* param: format
+*/
+bool WireReport(std::ostream& out, const WireFormat& format)
+{
+	const int SAMPLES = 1000;
+
+	std::vector<char> buffer;
+	ErrorTally errors;
+	size_t playerBits = 0, bulletBits = 0, asteroidBits = 0;
+
+	for (int i = 0; i < SAMPLES; ++i)
+	{
+		Vec2 position{ Sample(-400.f, 400.f, i, SAMPLES), Sample(-300.f, 300.f, SAMPLES - 1 - i, SAMPLES) };
+		Vec2 velocity{ Sample(-200.f, 200.f, i, SAMPLES), Sample(-200.f, 200.f, (i * 7) % SAMPLES, SAMPLES) };
+		// Deliberately outside [-pi, pi] to exercise the wrap
+		float angle = Sample(-12.f, 12.f, i, SAMPLES);
+
+		Player player{ i % 4 + 1, (i & 1) != 0, position, velocity, angle, 0 };
+		Bullet bullet{ i % 4 + 1, position };
+		ASTEROID asteroid(i * 7919, (i & 2) != 0, Sample(70.f, 140.f, i, SAMPLES), position, velocity, angle);
+
+		buffer.clear();
+		BitWriter writer(buffer);
+		WritePlayer(writer, player, format);
+		playerBits = writer.bit_count();
+		WriteBullet(writer, bullet, format);
+		bulletBits = writer.bit_count() - playerBits;
+		WriteAsteroid(writer, asteroid, format);
+		asteroidBits = writer.bit_count() - playerBits - bulletBits;
+		writer.flush();
+
+		Player playerOut{};
+		Bullet bulletOut{};
+		ASTEROID asteroidOut{};
+		BitReader reader(buffer.data(), buffer.size());
+		ReadPlayer(reader, playerOut, format);
+		ReadBullet(reader, bulletOut, format);
+		ReadAsteroid(reader, asteroidOut, format);
+
+		errors.exact = errors.exact && reader.ok() &&
+			playerOut.player_id == player.player_id && playerOut.shoot == player.shoot &&
+			bulletOut.player_id == bullet.player_id &&
+			asteroidOut._id == asteroid._id && asteroidOut._active == asteroid._active;
+
+		TallyVec2(errors.position, player.position, playerOut.position);
+		TallyVec2(errors.position, bullet.position, bulletOut.position);
+		TallyVec2(errors.position, asteroid._pos, asteroidOut._pos);
+		TallyVec2(errors.velocity, player.velocity, playerOut.velocity);
+		TallyVec2(errors.velocity, asteroid._vel, asteroidOut._vel);
+		Tally(errors.angle, AngleError(player.direction, playerOut.direction));
+		Tally(errors.angle, AngleError(asteroid._rot, asteroidOut._rot));
+		Tally(errors.size, std::fabs(asteroid._size - asteroidOut._size));
+	}
+
+	// Rounding to the nearest step keeps every error within half a step.
+	float positionStep = std::max(format.position_x.step(), format.position_y.step());
+	bool withinStep = errors.exact &&
+		playerBits == PlayerBits(format) && bulletBits == BulletBits(format) && asteroidBits == AsteroidBits(format) &&
+		errors.position <= positionStep * 0.5f + 1e-4f &&
+		errors.velocity <= format.velocity.step() * 0.5f + 1e-4f &&
+		errors.angle <= format.angle.step() * 0.5f + 1e-4f &&
+		errors.size <= format.size.step() * 0.5f + 1e-4f;
+
+	out << "Wire format (" << SAMPLES << " round trips)\n";
+	out << "  Player:   " << playerBits << " bits, " << (playerBits + 7) / 8 << " bytes (raw " << sizeof(Player) << ")\n";
+	out << "  Bullet:   " << bulletBits << " bits, " << (bulletBits + 7) / 8 << " bytes (raw " << sizeof(Bullet) << ")\n";
+	out << "  ASTEROID: " << asteroidBits << " bits, " << (asteroidBits + 7) / 8 << " bytes (raw " << sizeof(ASTEROID) << ")\n";
+	out << "  max error: position " << errors.position << " (step " << positionStep << ")"
+		<< ", velocity " << errors.velocity << " (step " << format.velocity.step() << ")"
+		<< ", angle " << errors.angle << " (step " << format.angle.step() << ")"
+		<< ", size " << errors.size << " (step " << format.size.step() << ")\n";
+	out << "  round trip " << (withinStep ? "OK" : "FAILED") << std::endl;
+
+	return withinStep;
+}